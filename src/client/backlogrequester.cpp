@@ -93,6 +93,13 @@ void FixedBacklogRequester::requestBacklog(const BufferIdList &bufferIds)
 {
     setWaitingBuffers(bufferIds);
     backlogManager->emitMessagesRequested(QObject::tr("Requesting a total of up to %1 backlog messages for %2 buffers").arg(_backlogCount * bufferIds.count()).arg(bufferIds.count()));
+    if (Client::isCoreFeatureEnabled(Quassel::Feature::BacklogRequestMulti)) {
+        QVariantList requests;
+        foreach(BufferId bufferId, bufferIds)
+            requests << QVariant(QVariantList() << qVariantFromValue(bufferId) << qVariantFromValue(MsgId(-1)) << _backlogCount);
+        backlogManager->requestBacklogMulti(requests);
+        return;
+    }
     foreach(BufferId bufferId, bufferIds) {
         backlogManager->requestBacklog(bufferId, -1, -1, _backlogCount);
     }
@@ -140,6 +147,13 @@ void PerBufferUnreadBacklogRequester::requestBacklog(const BufferIdList &bufferI
 {
     setWaitingBuffers(bufferIds);
     backlogManager->emitMessagesRequested(QObject::tr("Requesting a total of up to %1 unread backlog messages for %2 buffers").arg((_limit + _additional) * bufferIds.count()).arg(bufferIds.count()));
+    if (Client::isCoreFeatureEnabled(Quassel::Feature::BacklogRequestMulti)) {
+        QVariantList requests;
+        foreach(BufferId bufferId, bufferIds)
+            requests << QVariant(QVariantList() << qVariantFromValue(bufferId) << qVariantFromValue(Client::networkModel()->lastSeenMsgId(bufferId)) << _limit);
+        backlogManager->requestBacklogMulti(requests, _additional);
+        return;
+    }
     foreach(BufferId bufferId, bufferIds) {
         backlogManager->requestBacklog(bufferId, Client::networkModel()->lastSeenMsgId(bufferId), -1, _limit, _additional);
     }
@@ -24,6 +24,7 @@
 #include "backlogsettings.h"
 #include "backlogrequester.h"
 #include "client.h"
+#include "messageblock.h"
 
 #include <ctime>
 
@@ -45,18 +46,21 @@ QVariantList ClientBacklogManager::requestBacklog(BufferId bufferId, MsgId first
 }
 
 
+void ClientBacklogManager::requestBacklogMulti(const QVariantList &requests, int additional)
+{
+    foreach(const QVariant &request, requests)
+        _buffersRequested << request.toList().value(0).value<BufferId>();
+    BacklogManager::requestBacklogMulti(requests, additional);
+}
+
+
 void ClientBacklogManager::receiveBacklog(BufferId bufferId, MsgId first, MsgId last, int limit, int additional, QVariantList msgs)
 {
     Q_UNUSED(first) Q_UNUSED(last) Q_UNUSED(limit) Q_UNUSED(additional)
 
-    emit messagesReceived(bufferId, msgs.count());
+    MessageList msglist = backlogMessages(msgs);
 
-    MessageList msglist;
-    foreach(QVariant v, msgs) {
-        Message msg = v.value<Message>();
-        msg.setFlags(msg.flags() | Message::Backlog);
-        msglist << msg;
-    }
+    emit messagesReceived(bufferId, msglist.count());
 
     if (isBuffering()) {
         bool lastPart = !_requester->buffer(bufferId, msglist);
@@ -76,14 +80,47 @@ void ClientBacklogManager::receiveBacklogAll(MsgId first, MsgId last, int limit,
 {
     Q_UNUSED(first) Q_UNUSED(last) Q_UNUSED(limit) Q_UNUSED(additional)
 
+    dispatchMessages(backlogMessages(msgs));
+}
+
+
+void ClientBacklogManager::receiveSearchBacklog(BufferId bufferId, QString query, MsgId last, int limit, QVariantList msgIds)
+{
+    Q_UNUSED(last) Q_UNUSED(limit)
+
+    QList<MsgId> hits;
+    hits.reserve(msgIds.count());
+    foreach(const QVariant &msgId, msgIds)
+        hits << msgId.value<MsgId>();
+    emit backlogSearchResults(bufferId, query, hits);
+}
+
+
+void ClientBacklogManager::requestBacklogContext(BufferId bufferId, MsgId msgId, int contextLines)
+{
+    // Only the hit and what precedes it, rather than everything between it and the loaded backlog
+    requestBacklog(bufferId, -1, msgId.toQint64() + 1, contextLines + 1);
+}
+
+
+MessageList ClientBacklogManager::backlogMessages(const QVariantList &msgs) const
+{
     MessageList msglist;
+    // Cores supporting BacklogColumnar send a single MessageBlock instead of one QVariant per message
+    if (msgs.count() == 1 && msgs.first().type() == QVariant::ByteArray) {
+        msglist = MessageBlock::decode(msgs.first().toByteArray());
+        for (auto &&msg : msglist)
+            msg.setFlags(msg.flags() | Message::Backlog);
+        return msglist;
+    }
+
+    msglist.reserve(msgs.count());
     foreach(QVariant v, msgs) {
         Message msg = v.value<Message>();
         msg.setFlags(msg.flags() | Message::Backlog);
         msglist << msg;
     }
-
-    dispatchMessages(msglist);
+    return msglist;
 }
 
 
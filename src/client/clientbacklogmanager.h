@@ -41,8 +41,13 @@ public:
 
 public slots:
     virtual QVariantList requestBacklog(BufferId bufferId, MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0);
+    virtual void requestBacklogMulti(const QVariantList &requests, int additional = 0);
     virtual void receiveBacklog(BufferId bufferId, MsgId first, MsgId last, int limit, int additional, QVariantList msgs);
     virtual void receiveBacklogAll(MsgId first, MsgId last, int limit, int additional, QVariantList msgs);
+    virtual void receiveSearchBacklog(BufferId bufferId, QString query, MsgId last, int limit, QVariantList msgIds);
+
+    //! Fetches a search hit along with the given number of messages leading up to it
+    void requestBacklogContext(BufferId bufferId, MsgId msgId, int contextLines);
 
     void requestInitialBacklog();
 
@@ -51,6 +56,8 @@ public slots:
 
 signals:
     void messagesReceived(BufferId bufferId, int count) const;
+    //! Result page of a requestSearchBacklog() call, newest first
+    void backlogSearchResults(BufferId bufferId, const QString &query, const QList<MsgId> &msgIds);
     void messagesRequested(const QString &) const;
     void messagesProcessed(const QString &) const;
 
@@ -59,6 +66,7 @@ signals:
 private:
     bool isBuffering();
     BufferIdList filterNewBufferIds(const BufferIdList &bufferIds);
+    MessageList backlogMessages(const QVariantList &msgs) const;
 
     void dispatchMessages(const MessageList &messages, bool sort = false);
 
@@ -38,7 +38,7 @@ bool ClientIgnoreListManager::pureMatch(const IgnoreListItem &item, const QStrin
 QMap<QString, bool> ClientIgnoreListManager::matchingRulesForHostmask(const QString &hostmask, const QString &network, const QString &channel) const
 {
     QMap<QString, bool> result;
-    foreach(IgnoreListItem item, ignoreList()) {
+    for (const IgnoreListItem &item : ignoreList()) {
         if (item.type() == SenderIgnore && pureMatch(item, hostmask)
             && ((network.isEmpty() && channel.isEmpty())
                 || item.scope() == GlobalScope
@@ -151,6 +151,13 @@ bool MessageFilter::filterAcceptsRow(int sourceRow, const QModelIndex &sourcePar
     // MsgId msgId = sourceIdx.data(MessageModel::MsgIdRole).value<MsgId>();
     Message::Flags flags = (Message::Flags)sourceIdx.data(MessageModel::FlagsRole).toInt();
 
+    // Every view sees every message, but most of them belong to buffers it doesn't show. Unless such a message
+    // is redirected or a quit message for a query, it is rejected anyway, so don't bother with the network
+    // lookup and ignore list matching below.
+    if (!(flags & Message::Redirected) && !_validBuffers.contains(bufferId)
+        && !((messageType & Message::Quit) && bufferType() == BufferInfo::QueryBuffer))
+        return false;
+
     NetworkId myNetworkId = networkId();
     NetworkId msgNetworkId = Client::networkModel()->networkId(bufferId);
     if (myNetworkId != msgNetworkId)
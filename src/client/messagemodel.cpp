@@ -78,8 +78,9 @@ bool MessageModel::setData(const QModelIndex &index, const QVariant &value, int
 }
 
 
-bool MessageModel::insertMessage(const Message &msg, bool fakeMsg)
+bool MessageModel::insertMessage(const Message &message, bool fakeMsg)
 {
+    Message msg = internedMessage(message);
     MsgId id = msg.msgId();
     int idx = indexForId(id);
     if (!fakeMsg && idx < messageCount()) { // check for duplicate
@@ -92,11 +93,16 @@ bool MessageModel::insertMessage(const Message &msg, bool fakeMsg)
 }
 
 
-void MessageModel::insertMessages(const QList<Message> &msglist)
+void MessageModel::insertMessages(const QList<Message> &messages)
 {
-    if (msglist.isEmpty())
+    if (messages.isEmpty())
         return;
 
+    QList<Message> msglist;
+    msglist.reserve(messages.count());
+    foreach(const Message &msg, messages)
+        msglist << internedMessage(msg);
+
     if (_messageBuffer.isEmpty()) {
         int processedMsgs = insertMessagesGracefully(msglist);
         int remainingMsgs = msglist.count() - processedMsgs;
@@ -327,9 +333,47 @@ void MessageModel::customEvent(QEvent *event)
 }
 
 
+Message MessageModel::internedMessage(const Message &msg)
+{
+    // Messages arrive with their own copies of the buffer info and sender strings, even though those are the same
+    // for many of them. Share one copy of each instead, so the model doesn't keep them around once per message.
+    QHash<BufferId, BufferInfo>::iterator infoIt = _bufferInfos.find(msg.bufferId());
+    if (infoIt == _bufferInfos.end()) {
+        infoIt = _bufferInfos.insert(msg.bufferId(), msg.bufferInfo());
+    }
+    else {
+        // BufferInfo::operator== only compares the id, but the buffer might have been renamed
+        const BufferInfo &info = msg.bufferInfo();
+        if (infoIt->bufferName() != info.bufferName() || infoIt->networkId() != info.networkId()
+            || infoIt->type() != info.type() || infoIt->groupId() != info.groupId())
+            *infoIt = info;
+    }
+
+    Message interned(msg.timestamp(), *infoIt, msg.type(), msg.contents(), internedString(msg.sender()),
+                     internedString(msg.senderPrefixes()), internedString(msg.realName()), internedString(msg.avatarUrl()),
+                     msg.flags());
+    interned.setMsgId(msg.msgId());
+    return interned;
+}
+
+
+QString MessageModel::internedString(const QString &string)
+{
+    if (string.isEmpty())
+        return string;
+
+    QSet<QString>::const_iterator it = _internedStrings.constFind(string);
+    if (it == _internedStrings.constEnd())
+        it = _internedStrings.insert(string);
+    return *it;
+}
+
+
 void MessageModel::clear()
 {
     _messagesWaiting.clear();
+    _bufferInfos.clear();
+    _internedStrings.clear();
     if (rowCount() > 0) {
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
         removeAllMessages();
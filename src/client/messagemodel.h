@@ -23,6 +23,7 @@
 
 #include <QAbstractItemModel>
 #include <QDateTime>
+#include <QSet>
 #include <QTimer>
 
 #include "message.h"
@@ -109,11 +110,17 @@ private:
     int insertMessagesGracefully(const QList<Message> &); // inserts as many contiguous msgs as possible. returns numer of inserted msgs.
     int indexForId(MsgId);
 
+    //! Returns a copy of the message that shares its buffer info and sender strings with other messages in the model
+    Message internedMessage(const Message &msg);
+    QString internedString(const QString &string);
+
     //  QList<MessageModelItem *> _messageList;
     QList<Message> _messageBuffer;
     QTimer _dayChangeTimer;
     QDateTime _nextDayChange;
     QHash<BufferId, int> _messagesWaiting;
+    QHash<BufferId, BufferInfo> _bufferInfos; ///< Shared buffer info per buffer, see internedMessage()
+    QSet<QString> _internedStrings;           ///< Shared sender, prefix, real name and avatar strings
 
     /// Period of time for one day in milliseconds
     /// 24 hours * 60 minutes * 60 seconds * 1000 milliseconds
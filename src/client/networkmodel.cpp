@@ -979,22 +979,14 @@ void ChannelBufferItem::userModeChanged(IrcUser *ircUser)
     }
 
     // find the item that needs reparenting
-    IrcUserItem *ircUserItem = 0;
     for (int i = 0; i < childCount(); i++) {
         UserCategoryItem *oldCategoryItem = qobject_cast<UserCategoryItem *>(child(i));
         Q_ASSERT(oldCategoryItem);
-        IrcUserItem *userItem = oldCategoryItem->findIrcUser(ircUser);
-        if (userItem) {
-            ircUserItem = userItem;
-            break;
-        }
+        if (oldCategoryItem->moveUser(ircUser, categoryItem))
+            return;
     }
 
-    if (!ircUserItem) {
-        qWarning() << "ChannelBufferItem::userModeChanged(IrcUser *): unable to determine old category of" << ircUser;
-        return;
-    }
-    ircUserItem->reParent(categoryItem);
+    qWarning() << "ChannelBufferItem::userModeChanged(IrcUser *): unable to determine old category of" << ircUser;
 }
 
 
@@ -1045,15 +1037,10 @@ QString UserCategoryItem::categoryName() const
 
 IrcUserItem *UserCategoryItem::findIrcUser(IrcUser *ircUser)
 {
-    IrcUserItem *userItem = 0;
-
-    for (int i = 0; i < childCount(); i++) {
-        userItem = qobject_cast<IrcUserItem *>(child(i));
-        if (!userItem)
-            continue;
-        if (userItem->ircUser() == ircUser)
-            return userItem;
-    }
+    IrcUserItem *userItem = _userItems.value(ircUser);
+    // a deleted IrcUser's address might have been reused
+    if (userItem && userItem->ircUser() == ircUser)
+        return userItem;
     return 0;
 }
 
@@ -1061,8 +1048,11 @@ IrcUserItem *UserCategoryItem::findIrcUser(IrcUser *ircUser)
 void UserCategoryItem::addUsers(const QList<IrcUser *> &ircUsers)
 {
     QList<AbstractTreeItem *> userItems;
-    foreach(IrcUser *ircUser, ircUsers)
-    userItems << new IrcUserItem(ircUser, this);
+    foreach(IrcUser *ircUser, ircUsers) {
+        IrcUserItem *userItem = new IrcUserItem(ircUser, this);
+        _userItems[ircUser] = userItem;
+        userItems << userItem;
+    }
     newChilds(userItems);
     emit dataChanged(0);
 }
@@ -1073,6 +1063,7 @@ bool UserCategoryItem::removeUser(IrcUser *ircUser)
     IrcUserItem *userItem = findIrcUser(ircUser);
     bool success = (bool)userItem;
     if (success) {
+        _userItems.remove(ircUser);
         removeChild(userItem);
         emit dataChanged(0);
     }
@@ -1080,6 +1071,18 @@ bool UserCategoryItem::removeUser(IrcUser *ircUser)
 }
 
 
+bool UserCategoryItem::moveUser(IrcUser *ircUser, UserCategoryItem *newCategory)
+{
+    IrcUserItem *userItem = findIrcUser(ircUser);
+    if (!userItem || !userItem->reParent(newCategory))
+        return false;
+
+    _userItems.remove(ircUser);
+    newCategory->_userItems[ircUser] = userItem;
+    return true;
+}
+
+
 int UserCategoryItem::categoryFromModes(const QString &modes)
 {
     for (int i = 0; i < categories.count(); i++) {
@@ -1125,6 +1128,14 @@ IrcUserItem::IrcUserItem(IrcUser *ircUser, AbstractTreeItem *parent)
 }
 
 
+void IrcUserItem::ircUserQuited()
+{
+    UserCategoryItem *categoryItem = qobject_cast<UserCategoryItem *>(parent());
+    if (!categoryItem || !categoryItem->removeUser(_ircUser))
+        parent()->removeChild(this);
+}
+
+
 QStringList IrcUserItem::propertyOrder() const
 {
     static QStringList order{"nickName"};
@@ -267,11 +267,13 @@ public :
     IrcUserItem *findIrcUser(IrcUser *ircUser);
     void addUsers(const QList<IrcUser *> &ircUser);
     bool removeUser(IrcUser *ircUser);
+    bool moveUser(IrcUser *ircUser, UserCategoryItem *newCategory);
 
     static int categoryFromModes(const QString &modes);
 
 private:
     int _category;
+    QHash<IrcUser *, IrcUserItem *> _userItems;
 
     static const QList<QChar> categories;
 };
@@ -305,7 +307,7 @@ public :
     QString channelModes() const;
 
 private slots:
-    inline void ircUserQuited() { parent()->removeChild(this); }
+    void ircUserQuited();
 
 private:
     QPointer<IrcUser> _ircUser;
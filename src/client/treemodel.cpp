@@ -41,7 +41,9 @@ private:
 AbstractTreeItem::AbstractTreeItem(AbstractTreeItem *parent)
     : QObject(parent),
     _flags(Qt::ItemIsSelectable | Qt::ItemIsEnabled),
-    _treeItemFlags(0)
+    _treeItemFlags(0),
+    _row(-1),
+    _firstStaleRow(0)
 {
 }
 
@@ -50,7 +52,10 @@ bool AbstractTreeItem::newChild(AbstractTreeItem *item)
 {
     int newRow = childCount();
     emit beginAppendChilds(newRow, newRow);
+    item->_row = newRow;
     _childItems.append(item);
+    if (_firstStaleRow == newRow)
+        _firstStaleRow = childCount();
     emit endAppendChilds();
     return true;
 }
@@ -65,7 +70,11 @@ bool AbstractTreeItem::newChilds(const QList<AbstractTreeItem *> &items)
     int lastRow = nextRow + items.count() - 1;
 
     emit beginAppendChilds(nextRow, lastRow);
+    for (int i = 0; i < items.count(); i++)
+        items[i]->_row = nextRow + i;
     _childItems << items;
+    if (_firstStaleRow == nextRow)
+        _firstStaleRow = childCount();
     emit endAppendChilds();
 
     return true;
@@ -80,6 +89,7 @@ bool AbstractTreeItem::removeChild(int row)
     child(row)->removeAllChilds();
     emit beginRemoveChilds(row, row);
     AbstractTreeItem *treeitem = _childItems.takeAt(row);
+    _firstStaleRow = qMin(_firstStaleRow, row);
     delete treeitem;
     emit endRemoveChilds();
 
@@ -115,6 +125,7 @@ void AbstractTreeItem::removeAllChilds()
         childIter = _childItems.erase(childIter);
         delete child;
     }
+    _firstStaleRow = 0;
     emit endRemoveChilds();
 
     checkForDeletion();
@@ -163,6 +174,7 @@ bool AbstractTreeItem::reParent(AbstractTreeItem *newParent)
 
     emit parent()->beginRemoveChilds(oldRow, oldRow);
     parent()->_childItems.removeAt(oldRow);
+    parent()->_firstStaleRow = qMin(parent()->_firstStaleRow, oldRow);
     emit parent()->endRemoveChilds();
 
     AbstractTreeItem *oldParent = parent();
@@ -199,15 +211,30 @@ int AbstractTreeItem::childCount(int column) const
 
 int AbstractTreeItem::row() const
 {
-    if (!parent()) {
+    AbstractTreeItem *parentItem = parent();
+    if (!parentItem) {
         qWarning() << "AbstractTreeItem::row():" << this << "has no parent AbstractTreeItem as it's parent! parent is" << QObject::parent();
         return -1;
     }
 
-    int row_ = parent()->_childItems.indexOf(const_cast<AbstractTreeItem *>(this));
-    if (row_ == -1)
+    // Removing a child only marks the rows after it as stale, they get renumbered in one go
+    // once one of them is asked for
+    if (_row >= parentItem->_firstStaleRow)
+        parentItem->updateChildRows();
+
+    if (_row < 0 || _row >= parentItem->childCount() || parentItem->_childItems.at(_row) != this) {
         qWarning() << "AbstractTreeItem::row():" << this << "is not in the child list of" << QObject::parent();
-    return row_;
+        return -1;
+    }
+    return _row;
+}
+
+
+void AbstractTreeItem::updateChildRows() const
+{
+    for (int i = _firstStaleRow; i < _childItems.count(); i++)
+        _childItems.at(i)->_row = i;
+    _firstStaleRow = _childItems.count();
 }
 
 
@@ -89,6 +89,10 @@ private:
     Qt::ItemFlags _flags;
     TreeItemFlags _treeItemFlags;
 
+    mutable int _row;            ///< Cached position in the parent's child list, see row()
+    mutable int _firstStaleRow;  ///< Children from this row on may have an outdated cached row
+
+    void updateChildRows() const;
     void removeChildLater(AbstractTreeItem *child);
     inline void checkForDeletion()
     {
@@ -44,3 +44,14 @@ QVariantList BacklogManager::requestBacklogAllFiltered(MsgId first, MsgId last,
     REQUEST(ARG(first), ARG(last), ARG(limit), ARG(additional), ARG(type), ARG(flags))
     return QVariantList();
 }
+
+void BacklogManager::requestBacklogMulti(const QVariantList &requests, int additional)
+{
+    REQUEST(ARG(requests), ARG(additional))
+}
+
+QVariantList BacklogManager::requestSearchBacklog(BufferId bufferId, const QString &query, MsgId last, int limit)
+{
+    REQUEST(ARG(bufferId), ARG(query), ARG(last), ARG(limit))
+    return QVariantList();
+}
@@ -44,6 +44,15 @@ public slots:
     inline virtual void receiveBacklogAll(MsgId, MsgId, int, int, QVariantList) {};
     inline virtual void receiveBacklogAllFiltered(MsgId, MsgId, int, int, int, int, QVariantList) {};
 
+    //! Requests the backlog of several buffers at once
+    /** Each entry of \a requests is a QVariantList of BufferId, first MsgId and limit. The core replies
+     *  with a receiveBacklog() call per buffer, in the order the buffers become available.
+     */
+    virtual void requestBacklogMulti(const QVariantList &requests, int additional = 0);
+
+    virtual QVariantList requestSearchBacklog(BufferId bufferId, const QString &query, MsgId last = -1, int limit = -1);
+    inline virtual void receiveSearchBacklog(BufferId, QString, MsgId, int, QVariantList) {};
+
 signals:
     void backlogRequested(BufferId, MsgId, MsgId, int, int);
     void backlogAllRequested(MsgId, MsgId, int, int);
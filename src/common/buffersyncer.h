@@ -29,6 +29,8 @@ class BufferSyncer : public SyncableObject
 {
     SYNCABLE_OBJECT
         Q_OBJECT
+    // Only the latest activity and highlight count of a buffer matter
+    Q_CLASSINFO("CoalescedSyncs", "setBufferActivity:1 setHighlightCount:1")
 
 public:
     explicit BufferSyncer(QObject *parent);
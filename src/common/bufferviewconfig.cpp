@@ -165,6 +165,8 @@ void BufferViewConfig::initSetBufferList(const QVariantList &buffers)
     foreach(QVariant buffer, buffers) {
         _buffers << buffer.value<BufferId>();
     }
+    _bufferPositions.clear();
+    updateBufferPositions(0, _buffers.count() - 1);
 
     emit configChanged(); // used to track changes in the settingspage
 }
@@ -177,6 +179,8 @@ void BufferViewConfig::initSetBufferList(const QList<BufferId> &buffers)
     foreach(BufferId bufferId, buffers) {
         _buffers << bufferId;
     }
+    _bufferPositions.clear();
+    updateBufferPositions(0, _buffers.count() - 1);
 
     emit configChanged(); // used to track changes in the settingspage
 }
@@ -228,7 +232,7 @@ void BufferViewConfig::initSetTemporarilyRemovedBuffers(const QVariantList &buff
 
 void BufferViewConfig::addBuffer(const BufferId &bufferId, int pos)
 {
-    if (_buffers.contains(bufferId))
+    if (containsBuffer(bufferId))
         return;
 
     if (pos < 0)
@@ -243,6 +247,7 @@ void BufferViewConfig::addBuffer(const BufferId &bufferId, int pos)
         _temporarilyRemovedBuffers.remove(bufferId);
 
     _buffers.insert(pos, bufferId);
+    updateBufferPositions(pos, _buffers.count() - 1);
     SYNC(ARG(bufferId), ARG(pos))
     emit bufferAdded(bufferId, pos);
     emit configChanged();
@@ -251,7 +256,8 @@ void BufferViewConfig::addBuffer(const BufferId &bufferId, int pos)
 
 void BufferViewConfig::moveBuffer(const BufferId &bufferId, int pos)
 {
-    if (!_buffers.contains(bufferId))
+    int from = bufferPosition(bufferId);
+    if (from == -1)
         return;
 
     if (pos < 0)
@@ -259,7 +265,8 @@ void BufferViewConfig::moveBuffer(const BufferId &bufferId, int pos)
     if (pos >= _buffers.count())
         pos = _buffers.count() - 1;
 
-    _buffers.move(_buffers.indexOf(bufferId), pos);
+    _buffers.move(from, pos);
+    updateBufferPositions(qMin(from, pos), qMax(from, pos));
     SYNC(ARG(bufferId), ARG(pos))
     emit bufferMoved(bufferId, pos);
     emit configChanged();
@@ -268,8 +275,12 @@ void BufferViewConfig::moveBuffer(const BufferId &bufferId, int pos)
 
 void BufferViewConfig::removeBuffer(const BufferId &bufferId)
 {
-    if (_buffers.contains(bufferId))
-        _buffers.removeAt(_buffers.indexOf(bufferId));
+    int index = bufferPosition(bufferId);
+    if (index != -1) {
+        _buffers.removeAt(index);
+        _bufferPositions.remove(bufferId);
+        updateBufferPositions(index, _buffers.count() - 1);
+    }
 
     if (_removedBuffers.contains(bufferId))
         _removedBuffers.remove(bufferId);
@@ -283,8 +294,12 @@ void BufferViewConfig::removeBuffer(const BufferId &bufferId)
 
 void BufferViewConfig::removeBufferPermanently(const BufferId &bufferId)
 {
-    if (_buffers.contains(bufferId))
-        _buffers.removeAt(_buffers.indexOf(bufferId));
+    int index = bufferPosition(bufferId);
+    if (index != -1) {
+        _buffers.removeAt(index);
+        _bufferPositions.remove(bufferId);
+        updateBufferPositions(index, _buffers.count() - 1);
+    }
 
     if (_temporarilyRemovedBuffers.contains(bufferId))
         _temporarilyRemovedBuffers.remove(bufferId);
@@ -295,3 +310,11 @@ void BufferViewConfig::removeBufferPermanently(const BufferId &bufferId)
     emit bufferPermanentlyRemoved(bufferId);
     emit configChanged();
 }
+
+
+void BufferViewConfig::updateBufferPositions(int from, int to)
+{
+    for (int i = from; i <= to; i++) {
+        _bufferPositions[_buffers.at(i)] = i;
+    }
+}
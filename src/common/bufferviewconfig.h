@@ -84,6 +84,9 @@ public slots:
     virtual inline void requestSetBufferViewName(const QString &bufferViewName) { REQUEST(ARG(bufferViewName)) }
 
     const QList<BufferId> &bufferList() const { return _buffers; }
+    //! Position of the buffer within bufferList(), or -1 if it is not part of the view
+    inline int bufferPosition(const BufferId &bufferId) const { return _bufferPositions.value(bufferId, -1); }
+    inline bool containsBuffer(const BufferId &bufferId) const { return _bufferPositions.contains(bufferId); }
     const QSet<BufferId> &removedBuffers() const { return _removedBuffers; }
     const QSet<BufferId> &temporarilyRemovedBuffers() const { return _temporarilyRemovedBuffers; }
 
@@ -145,7 +148,11 @@ private:
     int _minimumActivity = 0;                ///< Minimum activity for a buffer to show
     bool _showSearch = false;                ///< Persistently show the buffer search UI
 
+    //! Refresh _bufferPositions for the entries of _buffers in [from, to]
+    void updateBufferPositions(int from, int to);
+
     QList<BufferId> _buffers;
+    QHash<BufferId, int> _bufferPositions;   ///< Index of each entry of _buffers, for fast lookup
     QSet<BufferId> _removedBuffers;
     QSet<BufferId> _temporarilyRemovedBuffers;
 };
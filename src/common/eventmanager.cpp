@@ -167,6 +167,7 @@ void EventManager::registerObject(QObject *object, Priority priority, const QStr
             //qDebug() << "Registered event filterer for" << methodSignature << "in" << object;
         }
     }
+    _dispatchPlans.clear();
 }
 
 
@@ -206,6 +207,7 @@ void EventManager::registerEventHandler(QList<EventType> events, QObject *object
             qDebug() << "Registered event handler for" << event << "in" << object;
         }
     }
+    _dispatchPlans.clear();
 }
 
 
@@ -247,58 +249,74 @@ void EventManager::processEvent(Event *event)
 }
 
 
-void EventManager::dispatchEvent(Event *event)
+EventManager::DispatchPlan EventManager::dispatchPlan(uint type, int num)
 {
-    //qDebug() << "Dispatching" << event;
+    uint planKey = num > 0 ? type + num : type;
+    QHash<uint, DispatchPlan>::const_iterator planIt = _dispatchPlans.constFind(planKey);
+    if (planIt != _dispatchPlans.constEnd())
+        return *planIt;
 
     // we try handlers from specialized to generic by masking the enum
 
     // build a list sorted by priorities that contains all eligible handlers
-    QList<Handler> handlers;
-    QHash<QObject *, Handler> filters;
-    QSet<QObject *> ignored;
-    uint type = event->type();
-
+    DispatchPlan plan;
     bool checkDupes = false;
 
     // special handling for numeric IrcEvents
-    if ((type & ~IrcEventNumericMask) == IrcEventNumeric) {
-        ::IrcEventNumeric *numEvent = static_cast< ::IrcEventNumeric *>(event);
-        if (!numEvent)
-            qWarning() << "Invalid event type for IrcEventNumeric!";
-        else {
-            int num = numEvent->number();
-            if (num > 0) {
-                insertHandlers(registeredHandlers().value(type + num), handlers, false);
-                insertFilters(registeredFilters().value(type + num), filters);
-                checkDupes = true;
-            }
-        }
+    if (num > 0) {
+        insertHandlers(registeredHandlers().value(type + num), plan.handlers, false);
+        insertFilters(registeredFilters().value(type + num), plan.filters);
+        checkDupes = true;
     }
 
     // exact type
-    insertHandlers(registeredHandlers().value(type), handlers, checkDupes);
-    insertFilters(registeredFilters().value(type), filters);
+    insertHandlers(registeredHandlers().value(type), plan.handlers, checkDupes);
+    insertFilters(registeredFilters().value(type), plan.filters);
 
     // check if we have a generic handler for the event group
     if ((type & EventGroupMask) != type) {
-        insertHandlers(registeredHandlers().value(type & EventGroupMask), handlers, true);
-        insertFilters(registeredFilters().value(type & EventGroupMask), filters);
+        insertHandlers(registeredHandlers().value(type & EventGroupMask), plan.handlers, true);
+        insertFilters(registeredFilters().value(type & EventGroupMask), plan.filters);
+    }
+
+    _dispatchPlans.insert(planKey, plan);
+    return plan;
+}
+
+
+void EventManager::dispatchEvent(Event *event)
+{
+    //qDebug() << "Dispatching" << event;
+
+    uint type = event->type();
+    int num = 0;
+
+    if ((type & ~IrcEventNumericMask) == IrcEventNumeric) {
+        ::IrcEventNumeric *numEvent = static_cast< ::IrcEventNumeric *>(event);
+        if (!numEvent)
+            qWarning() << "Invalid event type for IrcEventNumeric!";
+        else
+            num = numEvent->number();
     }
 
+    // Handlers may register new handlers while being called, which drops the cached plans.
+    // Holding a (shallow) copy keeps the lists we're iterating over alive.
+    const DispatchPlan plan = dispatchPlan(type, num);
+    QSet<QObject *> ignored;
+
     // now dispatch the event
     QList<Handler>::const_iterator it;
-    for (it = handlers.begin(); it != handlers.end() && !event->isStopped(); ++it) {
+    for (it = plan.handlers.begin(); it != plan.handlers.end() && !event->isStopped(); ++it) {
         QObject *obj = it->object;
 
         if (ignored.contains(obj)) // object has filtered the event
             continue;
 
-        if (filters.contains(obj)) { // we have a filter, so let's check if we want to deliver the event
-            Handler filter = filters.value(obj);
+        QHash<QObject *, Handler>::const_iterator filter = plan.filters.constFind(obj);
+        if (filter != plan.filters.constEnd()) { // we have a filter, so let's check if we want to deliver the event
             bool result = false;
             void *param[] = { Q_RETURN_ARG(bool, result).data(), Q_ARG(Event *, event).data() };
-            obj->qt_metacall(QMetaObject::InvokeMetaMethod, filter.methodIndex, param);
+            obj->qt_metacall(QMetaObject::InvokeMetaMethod, filter->methodIndex, param);
             if (!result) {
                 ignored.insert(obj);
                 continue; // mmmh, event filter told us to not accept
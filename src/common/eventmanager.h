@@ -169,6 +169,12 @@ private:
 
     typedef QHash<uint, QList<Handler> > HandlerHash;
 
+    //! The handlers and filters an event of a given type is delivered to
+    struct DispatchPlan {
+        QList<Handler> handlers; ///< Eligible handlers, sorted by priority
+        QHash<QObject *, Handler> filters;
+    };
+
     inline const HandlerHash &registeredHandlers() const { return _registeredHandlers; }
     inline HandlerHash &registeredHandlers() { return _registeredHandlers; }
 
@@ -185,11 +191,18 @@ private:
     void processEvent(Event *event);
     void dispatchEvent(Event *event);
 
+    //! Returns the dispatch plan for the given type (and numeric), building it on first use
+    /**
+      Plans only depend on the registered handlers and filters, so they are cached until the next registration.
+     */
+    DispatchPlan dispatchPlan(uint type, int num);
+
     //! @return the EventType enum
     static QMetaEnum eventEnum();
 
     HandlerHash _registeredHandlers;
     HandlerHash _registeredFilters;
+    QHash<uint, DispatchPlan> _dispatchPlans;
     QList<Event *> _eventQueue;
     static QMetaEnum _enum;
 };
@@ -0,0 +1,215 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2018 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "expressionmatchset.h"
+
+#include <QQueue>
+
+void ExpressionMatchSet::add(const ExpressionMatch &expression, int id)
+{
+    if (!expression.isValid()) {
+        // Invalid expressions never match, don't bother keeping them around
+        return;
+    }
+
+    Entry entry;
+    entry.expression = expression;
+    entry.id = id;
+    entry.literals = requiredLiterals(expression);
+    // An expression can only be skipped if every alternative has a literal
+    entry.alwaysCheck = entry.literals.isEmpty() || entry.literals.contains(QString());
+    _entries.append(entry);
+    _compiled = false;
+}
+
+
+void ExpressionMatchSet::clear()
+{
+    _entries.clear();
+    _nodes.clear();
+    _compiled = false;
+}
+
+
+QVector<int> ExpressionMatchSet::matches(const QString &string, bool matchEmpty) const
+{
+    QVector<int> result;
+    if (_entries.isEmpty()) {
+        return result;
+    }
+
+    compile();
+
+    // Single pass over the string, flagging every entry whose required literal shows up
+    //
+    // Literals are case-folded, so fold the string the same way.  This is a superset of what
+    // case-sensitive expressions accept, which is fine as every candidate gets verified below.
+    QVector<bool> candidates(_entries.count(), false);
+    const QString folded = string.toCaseFolded();
+    int state = 0;
+    for (int i = 0; i < folded.length(); i++) {
+        const ushort c = folded.at(i).unicode();
+        while (state != 0 && !_nodes.at(state).next.contains(c)) {
+            state = _nodes.at(state).fail;
+        }
+        state = _nodes.at(state).next.value(c, 0);
+        for (int entry : _nodes.at(state).outputs) {
+            candidates[entry] = true;
+        }
+    }
+
+    for (int i = 0; i < _entries.count(); i++) {
+        const Entry &entry = _entries.at(i);
+        if (entry.expression.isEmpty()) {
+            // Empty expressions have no literal, handle them the same way ExpressionMatch does
+            if (matchEmpty) {
+                result.append(entry.id);
+            }
+            continue;
+        }
+        if ((entry.alwaysCheck || candidates.at(i)) && entry.expression.match(string)) {
+            result.append(entry.id);
+        }
+    }
+    return result;
+}
+
+
+QStringList ExpressionMatchSet::requiredLiterals(const ExpressionMatch &expression)
+{
+    const QString source = expression.sourceExpression();
+
+    QStringList literals;
+    switch (expression.sourceMode()) {
+    case ExpressionMatch::MatchMode::MatchPhrase:
+        // The phrase itself must be present, only the word boundaries around it are checked later
+        literals.append(source);
+        break;
+    case ExpressionMatch::MatchMode::MatchMultiPhrase:
+        // Any one of the phrases must be present
+        literals = source.split("\n", QString::SkipEmptyParts);
+        break;
+    case ExpressionMatch::MatchMode::MatchWildcard:
+        // Inverted wildcards match nearly everything, always check those
+        if (!source.startsWith("!")) {
+            QString literal = longestWildcardLiteral(source);
+            if (!literal.isEmpty()) {
+                literals.append(literal);
+            }
+        }
+        break;
+    default:
+        // Multiple wildcards may be inverted, and regular expressions can't be reasoned about
+        // without a full parser.  Leave them to the underlying regular expression.
+        break;
+    }
+
+    for (QString &literal : literals) {
+        literal = literal.toCaseFolded();
+    }
+    return literals;
+}
+
+
+QString ExpressionMatchSet::longestWildcardLiteral(const QString &expression)
+{
+    // Split the expression on unescaped wildcards.  Any "\" also ends the current run; it either
+    // escapes a wildcard, collapses into a literal "\", or is dropped, so starting over afterwards
+    // only ever yields a shorter literal, never a wrong one.  See ExpressionMatch::wildcardToRegEx
+    QString longest;
+    int runStart = 0;
+    for (int i = 0; i <= expression.length(); i++) {
+        if (i < expression.length()) {
+            const QChar c = expression.at(i);
+            if (c != '*' && c != '?' && c != '\\') {
+                continue;
+            }
+        }
+        if (i - runStart > longest.length()) {
+            longest = expression.mid(runStart, i - runStart);
+        }
+        runStart = i + 1;
+    }
+    return longest;
+}
+
+
+void ExpressionMatchSet::compile() const
+{
+    if (_compiled) {
+        return;
+    }
+
+    // Build the trie of all literals
+    _nodes.clear();
+    _nodes.append(Node());
+    for (int i = 0; i < _entries.count(); i++) {
+        const Entry &entry = _entries.at(i);
+        if (entry.alwaysCheck) {
+            continue;
+        }
+        for (const QString &literal : entry.literals) {
+            int state = 0;
+            for (int j = 0; j < literal.length(); j++) {
+                const ushort c = literal.at(j).unicode();
+                int next = _nodes.at(state).next.value(c, 0);
+                if (next == 0) {
+                    next = _nodes.count();
+                    _nodes.append(Node());
+                    _nodes[state].next.insert(c, next);
+                }
+                state = next;
+            }
+            if (!_nodes.at(state).outputs.contains(i)) {
+                _nodes[state].outputs.append(i);
+            }
+        }
+    }
+
+    // Breadth-first pass to fill in failure links, merging outputs of suffix states so the scan
+    // never has to walk the failure chain for matches
+    QQueue<int> queue;
+    for (int child : _nodes.at(0).next) {
+        _nodes[child].fail = 0;
+        queue.enqueue(child);
+    }
+    while (!queue.isEmpty()) {
+        const int state = queue.dequeue();
+        const QHash<ushort, int> transitions = _nodes.at(state).next;
+        for (auto it = transitions.constBegin(); it != transitions.constEnd(); ++it) {
+            const ushort c = it.key();
+            const int child = it.value();
+            int fail = _nodes.at(state).fail;
+            while (fail != 0 && !_nodes.at(fail).next.contains(c)) {
+                fail = _nodes.at(fail).fail;
+            }
+            fail = _nodes.at(fail).next.value(c, 0);
+            _nodes[child].fail = fail;
+            for (int entry : _nodes.at(fail).outputs) {
+                if (!_nodes.at(child).outputs.contains(entry)) {
+                    _nodes[child].outputs.append(entry);
+                }
+            }
+            queue.enqueue(child);
+        }
+    }
+
+    _compiled = true;
+}
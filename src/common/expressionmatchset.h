@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2018 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "expressionmatch.h"
+
+/**
+ * Set of expression matchers evaluated together against a single string
+ *
+ * Phrase, multi-phrase and wildcard expressions contribute the literal text they require to a
+ * shared Aho-Corasick automaton, so one scan over the string finds every expression that can
+ * possibly match.  Only those candidates, plus expressions without a usable literal (regular
+ * expressions, inverted and multiple wildcards, "*"), are then checked with their own
+ * ExpressionMatch, so results are the same as calling ExpressionMatch::match() on each member.
+ */
+class ExpressionMatchSet
+{
+
+public:
+    /**
+     * Construct an empty ExpressionMatchSet
+     */
+    ExpressionMatchSet() {}
+
+    /**
+     * Adds an expression matcher to the set
+     *
+     * Invalid expressions are skipped.  Empty expressions are only kept if matchEmpty is passed to
+     * ExpressionMatchSet::matches(), mirroring ExpressionMatch::match().
+     *
+     * @param expression  Expression matcher to add
+     * @param id          Caller-defined identifier reported back on a match
+     */
+    void add(const ExpressionMatch &expression, int id);
+
+    /**
+     * Removes all expressions from the set
+     */
+    void clear();
+
+    /**
+     * Gets if the set holds no expressions
+     *
+     * @return True if no expressions were added, otherwise false
+     */
+    inline bool isEmpty() const { return _entries.isEmpty(); }
+
+    /**
+     * Finds all expressions matching the given string
+     *
+     * @param string      String to check
+     * @param matchEmpty  If true, empty expressions always match, otherwise they never match
+     * @return            Identifiers of matching expressions, in the order they were added
+     */
+    QVector<int> matches(const QString &string, bool matchEmpty = false) const;
+
+private:
+    /// Member expression with its caller-defined identifier
+    struct Entry {
+        ExpressionMatch expression = {};
+        int id = 0;
+        QStringList literals = {};   ///< Case-folded literals, at least one of which must be present
+        bool alwaysCheck = false;    ///< If true, no literal is known and the expression always runs
+    };
+
+    /// Aho-Corasick automaton state
+    struct Node {
+        QHash<ushort, int> next = {};  ///< Goto transitions by case-folded UTF-16 code unit
+        int fail = 0;                  ///< Longest proper suffix that is also a state
+        QVector<int> outputs = {};     ///< Entries whose literal ends here, including via suffixes
+    };
+
+    /**
+     * Gets the literals of which at least one must be present for the expression to match
+     *
+     * @param expression  Expression matcher to inspect
+     * @return            Case-folded literals, or an empty list if none are known
+     */
+    static QStringList requiredLiterals(const ExpressionMatch &expression);
+
+    /**
+     * Gets the longest run of literal characters in a wildcard expression
+     *
+     * @param expression  Noninverted wildcard expression
+     * @return            Longest literal run, or an empty string if none exists
+     */
+    static QString longestWildcardLiteral(const QString &expression);
+
+    /**
+     * Rebuild the automaton from the current entries if needed
+     */
+    void compile() const;
+
+    QVector<Entry> _entries = {};                   ///< Member expressions in insertion order
+
+    // These represent internal cache and should be safe to mutate in 'const' functions
+    mutable QVector<Node> _nodes = {};              ///< Automaton states, root at index 0
+    mutable bool _compiled = false;                 ///< If true, the automaton matches _entries
+};
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "expressionmatch.h"
+#include "expressionmatchset.h"
 
 void ExpressionMatchTests::runTests()
 {
@@ -38,6 +39,7 @@ void ExpressionMatchTests::runTests()
     runTestsMatchMultiWildcard();
     runTestsMatchRegEx();
     runTestsTrimMultiWildcardWhitespace();
+    runTestsMatchSet();
 
     qDebug() << "Passed all ExpressionMatch tests";
 }
@@ -484,3 +486,54 @@ void ExpressionMatchTests::runTestsTrimMultiWildcardWhitespace()
 
     qDebug() << "* Passed ExpressionMatch multiple wildcard whitespace trimming";
 }
+
+
+void ExpressionMatchTests::runTestsMatchSet()
+{
+    qDebug() << "> Testing ExpressionMatchSet matching";
+
+    // Expressions covering every mode, including ones without a usable literal
+    std::vector<ExpressionMatch> expressions = {
+        ExpressionMatch("test", ExpressionMatch::MatchMode::MatchPhrase, false),
+        ExpressionMatch("TeSt", ExpressionMatch::MatchMode::MatchPhrase, true),
+        ExpressionMatch("foo\nbar baz", ExpressionMatch::MatchMode::MatchMultiPhrase, false),
+        ExpressionMatch("*spam?link*", ExpressionMatch::MatchMode::MatchWildcard, false),
+        ExpressionMatch("*give\\*you*", ExpressionMatch::MatchMode::MatchWildcard, false),
+        ExpressionMatch(R"(\!escaped*)", ExpressionMatch::MatchMode::MatchWildcard, false),
+        ExpressionMatch("!*keep*", ExpressionMatch::MatchMode::MatchWildcard, false),
+        ExpressionMatch("*", ExpressionMatch::MatchMode::MatchWildcard, false),
+        ExpressionMatch("one*; !*two*", ExpressionMatch::MatchMode::MatchMultiWildcard, false),
+        ExpressionMatch("^re.ex$", ExpressionMatch::MatchMode::MatchRegEx, false),
+        ExpressionMatch("", ExpressionMatch::MatchMode::MatchPhrase, false)
+    };
+    QStringList strings = {
+        "test", "TeSt", "testing", "a test!", "FOO", "foo bar", "bar baz", "xspamYlinkx",
+        "spamlink", "give*you", "giveXyou", "!escaped", "escaped", "keep this", "one", "one two",
+        "regex", "REGEX", ""
+    };
+
+    ExpressionMatchSet set;
+    for (int i = 0; i < static_cast<int>(expressions.size()); i++) {
+        set.add(expressions[i], i);
+    }
+
+    // Assert the set reports exactly the members that match on their own, in insertion order
+    for (auto &&string : strings) {
+        for (bool matchEmpty : {false, true}) {
+            QVector<int> expected;
+            for (int i = 0; i < static_cast<int>(expressions.size()); i++) {
+                if (expressions[i].match(string, matchEmpty)) {
+                    expected.append(i);
+                }
+            }
+            Q_ASSERT(set.matches(string, matchEmpty) == expected);
+        }
+    }
+
+    // Assert clearing removes everything
+    set.clear();
+    Q_ASSERT(set.isEmpty());
+    Q_ASSERT(set.matches("test", true).isEmpty());
+
+    qDebug() << "* Passed ExpressionMatchSet matching";
+}
@@ -84,4 +84,9 @@ private:
      */
     static void runTestsTrimMultiWildcardWhitespace();
 
+    /**
+     * Tests ExpressionMatchSet against individually evaluated expressions
+     */
+    static void runTestsMatchSet();
+
 };
@@ -34,6 +34,7 @@ HighlightRuleManager &HighlightRuleManager::operator=(const HighlightRuleManager
 
     SyncableObject::operator=(other);
     _highlightRuleList = other._highlightRuleList;
+    _contentsMatchSetValid = false;
     _nicksCaseSensitive = other._nicksCaseSensitive;
     _highlightNick = other._highlightNick;
     return *this;
@@ -118,6 +119,7 @@ void HighlightRuleManager::initSetHighlightRuleList(const QVariantMap &highlight
     }
 
     _highlightRuleList.clear();
+    _contentsMatchSetValid = false;
     for (int i = 0; i < name.count(); i++) {
         _highlightRuleList << HighlightRule(id[i].toInt(), name[i], isRegEx[i].toBool(), isCaseSensitive[i].toBool(),
                                             isActive[i].toBool(), isInverse[i].toBool(), sender[i], channel[i]);
@@ -135,6 +137,7 @@ void HighlightRuleManager::addHighlightRule(int id, const QString &name, bool is
 
     HighlightRule newItem = HighlightRule(id, name, isRegEx, isCaseSensitive, isActive, isInverse, sender, channel);
     _highlightRuleList << newItem;
+    _contentsMatchSetValid = false;
 
     SYNC(ARG(id), ARG(name), ARG(isRegEx), ARG(isCaseSensitive), ARG(isActive), ARG(isInverse), ARG(sender),
          ARG(channel))
@@ -156,10 +159,15 @@ bool HighlightRuleManager::match(const NetworkId &netId,
 
     bool matches = false;
 
-    for (int i = 0; i < _highlightRuleList.count(); i++) {
+    // Strip formatting once per message rather than once per rule; every matcher below works on
+    // the unformatted text
+    const QString strippedContents = stripFormatCodes(msgContents);
+
+    // Check message contents of all enabled rules in one pass, allowing empty rules to match, then
+    // look at the remaining criteria of the rules that matched
+    updateContentsMatchSet();
+    for (int i : _contentsMatchSet.matches(strippedContents, true)) {
         auto &rule = _highlightRuleList.at(i);
-        if (!rule.isEnabled())
-            continue;
 
         // Skip if channel name doesn't match and channel rule is not empty
         //
@@ -173,20 +181,17 @@ bool HighlightRuleManager::match(const NetworkId &netId,
             continue;
         }
 
-        // Check message according to specified rule, allowing empty rules to match
-        bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
-
         // Check sender according to specified rule, allowing empty rules to match
-        bool senderMatch = rule.senderMatcher().match(msgSender, true);
-
-        if (contentsMatch && senderMatch) {
-            // If an inverse rule matches, then we know that we never want to return a highlight.
-            if (rule.isInverse()) {
-                return false;
-            }
-            else {
-                matches = true;
-            }
+        if (!rule.senderMatcher().match(msgSender, true)) {
+            continue;
+        }
+
+        // If an inverse rule matches, then we know that we never want to return a highlight.
+        if (rule.isInverse()) {
+            return false;
+        }
+        else {
+            matches = true;
         }
     }
 
@@ -197,7 +202,7 @@ bool HighlightRuleManager::match(const NetworkId &netId,
     if (_highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
         // Nickname matching allowed and current nickname is known
         // Run the nickname matcher on the unformatted string
-        if (_nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick, identityNicks)) {
+        if (_nickMatcher.match(strippedContents, netId, currentNick, identityNicks)) {
             return true;
         }
     }
@@ -206,6 +211,21 @@ bool HighlightRuleManager::match(const NetworkId &netId,
 }
 
 
+void HighlightRuleManager::updateContentsMatchSet()
+{
+    if (_contentsMatchSetValid)
+        return;
+
+    _contentsMatchSet.clear();
+    for (int i = 0; i < _highlightRuleList.count(); i++) {
+        const HighlightRule &rule = _highlightRuleList.at(i);
+        if (rule.isEnabled())
+            _contentsMatchSet.add(rule.contentsMatcher(), i);
+    }
+    _contentsMatchSetValid = true;
+}
+
+
 void HighlightRuleManager::removeHighlightRule(int highlightRule)
 {
     removeAt(indexOf(highlightRule));
@@ -219,6 +239,7 @@ void HighlightRuleManager::toggleHighlightRule(int highlightRule)
     if (idx == -1)
         return;
     _highlightRuleList[idx].setIsEnabled(!_highlightRuleList[idx].isEnabled());
+    _contentsMatchSetValid = false;
     SYNC(ARG(highlightRule))
 }
 
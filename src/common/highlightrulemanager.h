@@ -28,6 +28,7 @@
 #include <QVariantMap>
 
 #include "expressionmatch.h"
+#include "expressionmatchset.h"
 #include "message.h"
 #include "nickhighlightmatcher.h"
 #include "syncableobject.h"
@@ -302,9 +303,9 @@ public:
     inline bool contains(int rule) const { return indexOf(rule) != -1; }
     inline bool isEmpty() const { return _highlightRuleList.isEmpty(); }
     inline int count() const { return _highlightRuleList.count(); }
-    inline void removeAt(int index) { _highlightRuleList.removeAt(index); }
-    inline void clear() { _highlightRuleList.clear(); }
-    inline HighlightRule &operator[](int i) { return _highlightRuleList[i]; }
+    inline void removeAt(int index) { _highlightRuleList.removeAt(index); _contentsMatchSetValid = false; }
+    inline void clear() { _highlightRuleList.clear(); _contentsMatchSetValid = false; }
+    inline HighlightRule &operator[](int i) { _contentsMatchSetValid = false; return _highlightRuleList[i]; }
     inline const HighlightRule &operator[](int i) const { return _highlightRuleList.at(i); }
     inline const HighlightRuleList &highlightRuleList() const { return _highlightRuleList; }
 
@@ -395,7 +396,10 @@ public slots:
     }
 
 protected:
-    void setHighlightRuleList(const QList<HighlightRule> &HighlightRuleList) { _highlightRuleList = HighlightRuleList; }
+    void setHighlightRuleList(const QList<HighlightRule> &HighlightRuleList) {
+        _highlightRuleList = HighlightRuleList;
+        _contentsMatchSetValid = false;
+    }
 
     bool match(const NetworkId &netId,
                const QString &msgContents,
@@ -410,7 +414,14 @@ signals:
     void ruleAdded(QString name, bool isRegEx, bool isCaseSensitive, bool isEnabled, bool isInverse, QString sender, QString chanName);
 
 private:
+    /**
+     * Rebuild the combined contents matcher from the enabled rules if needed
+     */
+    void updateContentsMatchSet();
+
     HighlightRuleList _highlightRuleList = {}; ///< Custom highlight rule list
+    ExpressionMatchSet _contentsMatchSet = {}; ///< Enabled rule contents, by index in rule list
+    bool _contentsMatchSetValid = false;       ///< If false, the contents matcher needs rebuilding
     NickHighlightMatcher _nickMatcher = {};    ///< Nickname highlight matcher
 
     /// Nickname highlighting mode
@@ -32,6 +32,7 @@ IgnoreListManager &IgnoreListManager::operator=(const IgnoreListManager &other)
 
     SyncableObject::operator=(other);
     _ignoreList = other._ignoreList;
+    _matchSetsValid = false;
     return *this;
 }
 
@@ -96,6 +97,7 @@ void IgnoreListManager::initSetIgnoreList(const QVariantMap &ignoreList)
     }
 
     _ignoreList.clear();
+    _matchSetsValid = false;
     for (int i = 0; i < ignoreRule.count(); i++) {
         _ignoreList << IgnoreListItem(static_cast<IgnoreType>(ignoreType[i].toInt()), ignoreRule[i], isRegEx[i].toBool(),
             static_cast<StrictnessType>(strictness[i].toInt()), static_cast<ScopeType>(scope[i].toInt()),
@@ -119,6 +121,7 @@ void IgnoreListManager::addIgnoreListItem(int type, const QString &ignoreRule, b
     IgnoreListItem newItem = IgnoreListItem(static_cast<IgnoreType>(type), ignoreRule, isRegEx, static_cast<StrictnessType>(strictness),
         static_cast<ScopeType>(scope), scopeRule, isActive);
     _ignoreList << newItem;
+    _matchSetsValid = false;
 
     SYNC(ARG(type), ARG(ignoreRule), ARG(isRegEx), ARG(strictness), ARG(scope), ARG(scopeRule), ARG(isActive))
 }
@@ -132,29 +135,48 @@ IgnoreListManager::StrictnessType IgnoreListManager::_match(const QString &msgCo
     if (!(msgType & (Message::Plain | Message::Notice | Message::Action)))
         return UnmatchedStrictness;
 
-    foreach(IgnoreListItem item, _ignoreList) {
-        if (!item.isEnabled() || item.type() == CtcpIgnore)
-            continue;
-        if (item.scope() == GlobalScope
-            || (item.scope() == NetworkScope && item.scopeRuleMatcher().match(network))
-            || (item.scope() == ChannelScope && item.scopeRuleMatcher().match(bufferName))) {
-            QString str;
-            if (item.type() == MessageIgnore)
-                str = msgContents;
-            else
-                str = msgSender;
-
-//      qDebug() << "IgnoreListManager::match: ";
-//      qDebug() << "string: " << str;
-//      qDebug() << "pattern: " << ruleRx.pattern();
-//      qDebug() << "scopeRule: " << item.scopeRule;
-//      qDebug() << "now testing";
-            if (item.contentsMatcher().match(str)) {
-                return item.strictness();
+    updateMatchSets();
+
+    // Run each rule set over its string once, then keep the strongest strictness among the
+    // matching rules whose scope applies
+    StrictnessType strictness = UnmatchedStrictness;
+    auto applyMatches = [&](const QVector<int> &matches) {
+        for (int index : matches) {
+            const IgnoreListItem &item = _ignoreList.at(index);
+            if (item.strictness() <= strictness)
+                continue;
+            if (item.scope() == GlobalScope
+                || (item.scope() == NetworkScope && item.scopeRuleMatcher().match(network))
+                || (item.scope() == ChannelScope && item.scopeRuleMatcher().match(bufferName))) {
+                strictness = item.strictness();
             }
         }
+    };
+
+    applyMatches(_messageMatchSet.matches(msgContents));
+    if (strictness != HardStrictness)
+        applyMatches(_senderMatchSet.matches(msgSender));
+    return strictness;
+}
+
+
+void IgnoreListManager::updateMatchSets()
+{
+    if (_matchSetsValid)
+        return;
+
+    _messageMatchSet.clear();
+    _senderMatchSet.clear();
+    for (int i = 0; i < _ignoreList.count(); i++) {
+        const IgnoreListItem &item = _ignoreList.at(i);
+        if (!item.isEnabled())
+            continue;
+        if (item.type() == MessageIgnore)
+            _messageMatchSet.add(item.contentsMatcher(), i);
+        else if (item.type() == SenderIgnore)
+            _senderMatchSet.add(item.contentsMatcher(), i);
     }
-    return UnmatchedStrictness;
+    _matchSetsValid = true;
 }
 
 
@@ -171,13 +193,14 @@ void IgnoreListManager::toggleIgnoreRule(const QString &ignoreRule)
     if (idx == -1)
         return;
     _ignoreList[idx].setIsEnabled(!_ignoreList[idx].isEnabled());
+    _matchSetsValid = false;
     SYNC(ARG(ignoreRule))
 }
 
 
 bool IgnoreListManager::ctcpMatch(const QString sender, const QString &network, const QString &type)
 {
-    foreach(IgnoreListItem item, _ignoreList) {
+    for (const IgnoreListItem &item : ignoreList()) {
         if (!item.isEnabled())
             continue;
         if (item.scope() == GlobalScope
@@ -27,6 +27,7 @@
 #include <QRegExp>
 
 #include "expressionmatch.h"
+#include "expressionmatchset.h"
 #include "message.h"
 #include "syncableobject.h"
 
@@ -338,8 +339,8 @@ public:
     inline bool contains(const QString &ignore) const { return indexOf(ignore) != -1; }
     inline bool isEmpty() const { return _ignoreList.isEmpty(); }
     inline int count() const { return _ignoreList.count(); }
-    inline void removeAt(int index) { _ignoreList.removeAt(index); }
-    inline IgnoreListItem &operator[](int i) { return _ignoreList[i]; }
+    inline void removeAt(int index) { _ignoreList.removeAt(index); _matchSetsValid = false; }
+    inline IgnoreListItem &operator[](int i) { _matchSetsValid = false; return _ignoreList[i]; }
     inline const IgnoreListItem &operator[](int i) const { return _ignoreList.at(i); }
     inline const IgnoreList &ignoreList() const { return _ignoreList; }
 
@@ -396,7 +397,7 @@ public slots:
         int scope, const QString &scopeRule, bool isActive);
 
 protected:
-    void setIgnoreList(const QList<IgnoreListItem> &ignoreList) { _ignoreList = ignoreList; }
+    void setIgnoreList(const QList<IgnoreListItem> &ignoreList) { _ignoreList = ignoreList; _matchSetsValid = false; }
 
     StrictnessType _match(const QString &msgContents, const QString &msgSender, Message::Type msgType, const QString &network, const QString &bufferName);
 
@@ -404,7 +405,16 @@ signals:
     void ignoreAdded(IgnoreType type, const QString &ignoreRule, bool isRegex, StrictnessType strictness, ScopeType scope, const QVariant &scopeRule, bool isActive);
 
 private:
+    /**
+     * Rebuild the combined matchers from the enabled message and sender rules if needed
+     */
+    void updateMatchSets();
+
     IgnoreList _ignoreList;
+
+    ExpressionMatchSet _messageMatchSet;  ///< Enabled MessageIgnore rules, by index in _ignoreList
+    ExpressionMatchSet _senderMatchSet;   ///< Enabled SenderIgnore rules, by index in _ignoreList
+    bool _matchSetsValid = false;         ///< If false, the match sets need to be rebuilt
 };
 
 
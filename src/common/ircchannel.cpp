@@ -197,7 +197,6 @@ void IrcChannel::joinIrcUsers(const QList<IrcUser *> &users, const QStringList &
 
         _userModes[ircuser] = sortedModes[i];
         ircuser->joinChannel(this, true);
-        connect(ircuser, SIGNAL(nickSet(QString)), this, SLOT(ircUserNickSet(QString)));
 
         // connect(ircuser, SIGNAL(destroyed()), this, SLOT(ircUserDestroyed()));
         // If you wonder why there is no counterpart to ircUserJoined:
@@ -218,10 +217,7 @@ void IrcChannel::joinIrcUsers(const QList<IrcUser *> &users, const QStringList &
 
 void IrcChannel::joinIrcUsers(const QStringList &nicks, const QStringList &modes)
 {
-    QList<IrcUser *> users;
-    foreach(QString nick, nicks)
-    users << network()->newIrcUser(nick);
-    joinIrcUsers(users, modes);
+    joinIrcUsers(network()->newIrcUsers(nicks), modes);
 }
 
 
@@ -242,7 +238,6 @@ void IrcChannel::part(IrcUser *ircuser)
         ircuser->partChannel(this);
         // If you wonder why there is no counterpart to ircUserParted:
         // the joins are propagted by the ircuser. The signal ircUserParted is only for convenience
-        disconnect(ircuser, 0, this, 0);
         emit ircUserParted(ircuser);
 
         if (network()->isMe(ircuser) || _userModes.isEmpty()) {
@@ -251,7 +246,6 @@ void IrcChannel::part(IrcUser *ircuser)
             QList<IrcUser *> users = _userModes.keys();
             _userModes.clear();
             foreach(IrcUser *user, users) {
-                disconnect(user, 0, this, 0);
                 user->partChannel(this);
             }
             emit parted();
@@ -438,14 +432,6 @@ void IrcChannel::ircUserDestroyed()
 }
 
 
-void IrcChannel::ircUserNickSet(QString nick)
-{
-    IrcUser *ircUser = qobject_cast<IrcUser *>(sender());
-    Q_ASSERT(ircUser);
-    emit ircUserNickSet(ircUser, nick);
-}
-
-
 /*******************************************************************************
  *
  * 3.3 CHANMODES
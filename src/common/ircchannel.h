@@ -129,7 +129,6 @@ signals:
 
 private slots:
     void ircUserDestroyed();
-    void ircUserNickSet(QString nick);
 
 private:
     bool _initialized;
@@ -149,6 +148,8 @@ private:
     QHash<QChar, QString> _B_channelModes;
     QHash<QChar, QString> _C_channelModes;
     QSet<QChar> _D_channelModes;
+
+    friend class IrcUser;
 };
 
 
@@ -257,9 +257,16 @@ void IrcUser::setHost(const QString &host)
 void IrcUser::setNick(const QString &nick)
 {
     if (!nick.isEmpty() && nick != _nick) {
+        QString oldNick = _nick;
         _nick = nick;
         updateObjectName();
         SYNC(ARG(nick))
+        // Notify the network and our channels directly instead of having each of them connect to
+        // nickSet(); in large channels those per-member connections add up
+        network()->ircUserNickChanged(this, oldNick);
+        foreach(IrcChannel *channel, _channels) {
+            emit channel->ircUserNickSet(this, nick);
+        }
         emit nickSet(nick);
     }
 }
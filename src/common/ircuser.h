@@ -38,6 +38,7 @@ class IrcUser : public SyncableObject
 {
     SYNCABLE_OBJECT
     Q_OBJECT
+    Q_CLASSINFO("CoalescedSyncs", "setLastAwayMessageTime:0 setIdleTime:0")
 
     Q_PROPERTY(QString user READ user WRITE setUser)
     Q_PROPERTY(QString host READ host WRITE setHost)
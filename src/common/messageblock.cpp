@@ -0,0 +1,337 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2018 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#include "messageblock.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace {
+
+// Bump when changing the layout; decoders reject blocks with an unknown version
+const quint8 blockVersion = 2;
+
+void writeVarUInt(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+
+// Zig-zag encoding, so that small negative deltas stay small
+void writeVarInt(QByteArray &out, qint64 value)
+{
+    writeVarUInt(out, (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+
+void writeString(QByteArray &out, const QString &string)
+{
+    QByteArray utf8 = string.toUtf8();
+    writeVarUInt(out, utf8.size());
+    out.append(utf8);
+}
+
+
+//! Reads values from an encoded block, remembering if it ran past the end or hit garbage
+class BlockReader
+{
+public:
+    BlockReader(const QByteArray &block) : _pos(block.constData()), _end(block.constData() + block.size()) {}
+
+    bool isValid() const { return _valid; }
+    bool atEnd() const { return _pos == _end; }
+
+    quint8 readByte()
+    {
+        if (_pos >= _end) {
+            _valid = false;
+            return 0;
+        }
+        return static_cast<quint8>(*_pos++);
+    }
+
+    quint64 readVarUInt()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            quint8 byte = readByte();
+            if (!_valid)
+                return 0;
+            value |= static_cast<quint64>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        _valid = false;
+        return 0;
+    }
+
+    qint64 readVarInt()
+    {
+        quint64 value = readVarUInt();
+        return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+    }
+
+    //! Reads a count that must not exceed the remaining size, so garbage can't trigger huge allocations
+    int readCount()
+    {
+        quint64 count = readVarUInt();
+        if (count > static_cast<quint64>(_end - _pos)) {
+            _valid = false;
+            return 0;
+        }
+        return static_cast<int>(count);
+    }
+
+    QString readString()
+    {
+        int size = readCount();
+        if (!_valid)
+            return QString();
+        QString string = QString::fromUtf8(_pos, size);
+        _pos += size;
+        return string;
+    }
+
+private:
+    const char *_pos;
+    const char *_end;
+    bool _valid{true};
+};
+
+
+struct SenderEntry
+{
+    QString sender;
+    QString senderPrefixes;
+    QString realName;
+    QString avatarUrl;
+
+    bool operator==(const SenderEntry &other) const
+    {
+        return sender == other.sender && senderPrefixes == other.senderPrefixes
+               && realName == other.realName && avatarUrl == other.avatarUrl;
+    }
+};
+
+
+uint qHash(const SenderEntry &entry)
+{
+    return ::qHash(entry.sender) ^ ::qHash(entry.senderPrefixes) ^ ::qHash(entry.realName) ^ ::qHash(entry.avatarUrl);
+}
+
+}
+
+
+/* Layout:
+ *   version (byte), message count, buffer count, sender count
+ *   buffers: bufferId, networkId, type, groupId, name
+ *   senders: sender, prefixes, real name, avatar URL
+ *   then one column per message field, each holding the values of all messages in order:
+ *   msgId deltas, timestamp deltas (ms), types, flags, buffer indices, sender indices, contents
+ */
+QByteArray MessageBlock::encode(const MessageList &messages)
+{
+    QHash<BufferId, int> bufferIndex;
+    QList<BufferInfo> buffers;
+    QHash<SenderEntry, int> senderIndex;
+    QList<SenderEntry> senders;
+    QList<int> messageBuffers;
+    QList<int> messageSenders;
+    messageBuffers.reserve(messages.size());
+    messageSenders.reserve(messages.size());
+
+    for (const Message &msg : messages) {
+        int buffer = bufferIndex.value(msg.bufferId(), -1);
+        if (buffer < 0) {
+            buffer = buffers.size();
+            bufferIndex.insert(msg.bufferId(), buffer);
+            buffers << msg.bufferInfo();
+        }
+        messageBuffers << buffer;
+
+        SenderEntry entry{msg.sender(), msg.senderPrefixes(), msg.realName(), msg.avatarUrl()};
+        int sender = senderIndex.value(entry, -1);
+        if (sender < 0) {
+            sender = senders.size();
+            senderIndex.insert(entry, sender);
+            senders << entry;
+        }
+        messageSenders << sender;
+    }
+
+    QByteArray block;
+    block.append(static_cast<char>(blockVersion));
+    writeVarUInt(block, messages.size());
+    writeVarUInt(block, buffers.size());
+    writeVarUInt(block, senders.size());
+
+    for (const BufferInfo &info : buffers) {
+        writeVarInt(block, info.bufferId().toInt());
+        writeVarInt(block, info.networkId().toInt());
+        writeVarUInt(block, static_cast<quint16>(info.type()));
+        writeVarUInt(block, info.groupId());
+        writeString(block, info.bufferName());
+    }
+
+    for (const SenderEntry &entry : senders) {
+        writeString(block, entry.sender);
+        writeString(block, entry.senderPrefixes);
+        writeString(block, entry.realName);
+        writeString(block, entry.avatarUrl);
+    }
+
+    qint64 lastMsgId = 0;
+    for (const Message &msg : messages) {
+        qint64 msgId = msg.msgId().toQint64();
+        writeVarInt(block, msgId - lastMsgId);
+        lastMsgId = msgId;
+    }
+
+    qint64 lastTimestamp = 0;
+    for (const Message &msg : messages) {
+        qint64 timestamp = msg.timestamp().toMSecsSinceEpoch();
+        writeVarInt(block, timestamp - lastTimestamp);
+        lastTimestamp = timestamp;
+    }
+
+    for (const Message &msg : messages)
+        writeVarUInt(block, static_cast<quint32>(msg.type()));
+    for (const Message &msg : messages)
+        writeVarUInt(block, static_cast<quint8>(msg.flags()));
+    for (int buffer : messageBuffers)
+        writeVarUInt(block, buffer);
+    for (int sender : messageSenders)
+        writeVarUInt(block, sender);
+    for (const Message &msg : messages)
+        writeString(block, msg.contents());
+
+    return block;
+}
+
+
+MessageList MessageBlock::decode(const QByteArray &block, bool *ok)
+{
+    if (ok)
+        *ok = false;
+
+    BlockReader reader(block);
+    quint8 version = reader.readByte();
+    if (!reader.isValid() || version != blockVersion) {
+        qWarning() << "Unsupported message block version" << version;
+        return MessageList();
+    }
+
+    int messageCount = reader.readCount();
+    int bufferCount = reader.readCount();
+    int senderCount = reader.readCount();
+
+    QList<BufferInfo> buffers;
+    for (int i = 0; i < bufferCount && reader.isValid(); ++i) {
+        BufferId bufferId = static_cast<int>(reader.readVarInt());
+        NetworkId networkId = static_cast<int>(reader.readVarInt());
+        auto type = static_cast<BufferInfo::Type>(reader.readVarUInt());
+        auto groupId = static_cast<uint>(reader.readVarUInt());
+        buffers << BufferInfo(bufferId, networkId, type, groupId, reader.readString());
+    }
+
+    QList<SenderEntry> senders;
+    for (int i = 0; i < senderCount && reader.isValid(); ++i) {
+        SenderEntry entry;
+        entry.sender = reader.readString();
+        entry.senderPrefixes = reader.readString();
+        entry.realName = reader.readString();
+        entry.avatarUrl = reader.readString();
+        senders << entry;
+    }
+
+    // messageCount is bounded by the block size, and every column needs at least one byte per message
+    QVector<qint64> msgIds(messageCount);
+    qint64 msgId = 0;
+    for (int i = 0; i < messageCount && reader.isValid(); ++i) {
+        msgId += reader.readVarInt();
+        msgIds[i] = msgId;
+    }
+
+    QVector<qint64> timestamps(messageCount);
+    qint64 timestamp = 0;
+    for (int i = 0; i < messageCount && reader.isValid(); ++i) {
+        timestamp += reader.readVarInt();
+        timestamps[i] = timestamp;
+    }
+
+    QVector<quint32> types(messageCount);
+    for (int i = 0; i < messageCount && reader.isValid(); ++i)
+        types[i] = static_cast<quint32>(reader.readVarUInt());
+
+    QVector<int> flags(messageCount);
+    for (int i = 0; i < messageCount && reader.isValid(); ++i)
+        flags[i] = static_cast<int>(reader.readVarUInt());
+
+    QVector<int> messageBuffers(messageCount);
+    for (int i = 0; i < messageCount && reader.isValid(); ++i) {
+        quint64 buffer = reader.readVarUInt();
+        if (buffer >= static_cast<quint64>(buffers.size())) {
+            qWarning() << "Malformed message block, dropping it";
+            return MessageList();
+        }
+        messageBuffers[i] = static_cast<int>(buffer);
+    }
+
+    QVector<int> messageSenders(messageCount);
+    for (int i = 0; i < messageCount && reader.isValid(); ++i) {
+        quint64 sender = reader.readVarUInt();
+        if (sender >= static_cast<quint64>(senders.size())) {
+            qWarning() << "Malformed message block, dropping it";
+            return MessageList();
+        }
+        messageSenders[i] = static_cast<int>(sender);
+    }
+
+    QStringList contents;
+    contents.reserve(messageCount);
+    for (int i = 0; i < messageCount && reader.isValid(); ++i)
+        contents << reader.readString();
+
+    if (!reader.isValid() || !reader.atEnd()) {
+        qWarning() << "Malformed message block, dropping it";
+        return MessageList();
+    }
+
+    MessageList messages;
+    messages.reserve(messageCount);
+    for (int i = 0; i < messageCount; ++i) {
+        const SenderEntry &entry = senders.at(messageSenders.at(i));
+        Message msg(QDateTime::fromMSecsSinceEpoch(timestamps.at(i)), buffers.at(messageBuffers.at(i)),
+                    static_cast<Message::Type>(types.at(i)), contents.at(i),
+                    entry.sender, entry.senderPrefixes, entry.realName, entry.avatarUrl, Message::Flags(flags.at(i)));
+        msg.setMsgId(msgIds.at(i));
+        messages << msg;
+    }
+
+    if (ok)
+        *ok = true;
+    return messages;
+}
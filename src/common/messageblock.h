@@ -0,0 +1,52 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2018 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+
+#include "message.h"
+
+/**
+ * Compact columnar encoding for lists of messages, used for sending backlog to peers supporting
+ * Quassel::Feature::BacklogColumnar.
+ *
+ * Instead of serializing every message as a type-tagged QVariant, the block stores each field as a
+ * column: message IDs and timestamps are delta-encoded, buffers and senders are stored once in a
+ * dictionary and referenced by index, and contents are raw UTF-8. All integers are written as
+ * variable-length quantities.
+ *
+ * The encoding always includes all optional message fields (sender prefixes, real name, avatar URL,
+ * 64-bit IDs and millisecond timestamps), since every peer supporting it supports those as well.
+ */
+class MessageBlock
+{
+public:
+    //! Encodes the given messages into a single block
+    static QByteArray encode(const MessageList &messages);
+
+    //! Decodes a block created by encode()
+    /**
+     * @param[in]  block The encoded block
+     * @param[out] ok    If given, set to whether the block could be decoded
+     * @returns The decoded messages, or an empty list if the block is malformed
+     */
+    static MessageList decode(const QByteArray &block, bool *ok = nullptr);
+};
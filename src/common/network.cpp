@@ -46,6 +46,7 @@ Network::Network(const NetworkId &networkid, QObject *parent)
     _connectionState(Disconnected),
     _prefixes(QString()),
     _prefixModes(QString()),
+    _caseMapping(Rfc1459CaseMapping),
     _useRandomServer(false),
     _useAutoIdentify(false),
     _useSasl(false),
@@ -280,6 +281,86 @@ QString Network::support(const QString &param) const
 }
 
 
+namespace {
+
+//! Folds a single character, except for UnicodeCaseMapping which is handled by the caller
+inline ushort ircLowerChar(ushort c, Network::CaseMapping caseMapping)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c + ('a' - 'A');
+    if (caseMapping == Network::AsciiCaseMapping)
+        return c;
+
+    switch (c) {
+    case '[':
+        return '{';
+    case ']':
+        return '}';
+    case '\\':
+        return '|';
+    case '~':
+        return (caseMapping == Network::Rfc1459CaseMapping) ? '^' : c;
+    default:
+        return c;
+    }
+}
+
+}
+
+
+QString Network::ircLower(const QString &name) const
+{
+    if (_caseMapping == UnicodeCaseMapping)
+        return name.toLower();
+
+    // Skip ahead to the first character that actually changes, most lookups are already folded
+    const int length = name.length();
+    int i = 0;
+    while (i < length && ircLowerChar(name.at(i).unicode(), _caseMapping) == name.at(i).unicode())
+        i++;
+    if (i == length)
+        return name;
+
+    QString folded = name;
+    QChar *data = folded.data();
+    for (; i < length; i++)
+        data[i] = QChar(ircLowerChar(data[i].unicode(), _caseMapping));
+    return folded;
+}
+
+
+void Network::updateCaseMapping()
+{
+    QString mapping = support("CASEMAPPING").toLower();
+    CaseMapping caseMapping;
+    if (mapping.isEmpty() || mapping == "rfc1459")
+        caseMapping = Rfc1459CaseMapping;
+    else if (mapping == "strict-rfc1459")
+        caseMapping = StrictRfc1459CaseMapping;
+    else if (mapping == "ascii")
+        caseMapping = AsciiCaseMapping;
+    else
+        caseMapping = UnicodeCaseMapping;
+
+    if (caseMapping == _caseMapping)
+        return;
+    _caseMapping = caseMapping;
+
+    // Rekey everything that's already known under the new mapping
+    QHash<QString, IrcUser *> users;
+    foreach(IrcUser *ircuser, _ircUsers) {
+        users[ircLower(ircuser->nick())] = ircuser;
+    }
+    _ircUsers = users;
+
+    QHash<QString, IrcChannel *> channels;
+    foreach(IrcChannel *channel, _ircChannels) {
+        channels[ircLower(channel->name())] = channel;
+    }
+    _ircChannels = channels;
+}
+
+
 bool Network::saslMaybeSupports(const QString &saslMechanism) const
 {
     if (!capAvailable(IrcCap::SASL)) {
@@ -304,22 +385,9 @@ bool Network::saslMaybeSupports(const QString &saslMechanism) const
 
 IrcUser *Network::newIrcUser(const QString &hostmask, const QVariantMap &initData)
 {
-    QString nick(nickFromMask(hostmask).toLower());
+    QString nick(ircLower(nickFromMask(hostmask)));
     if (!_ircUsers.contains(nick)) {
-        IrcUser *ircuser = ircUserFactory(hostmask);
-        if (!initData.isEmpty()) {
-            ircuser->fromVariantMap(initData);
-            ircuser->setInitialized();
-        }
-
-        if (proxy())
-            proxy()->synchronize(ircuser);
-        else
-            qWarning() << "unable to synchronize new IrcUser" << hostmask << "forgot to call Network::setProxy(SignalProxy *)?";
-
-        connect(ircuser, SIGNAL(nickSet(QString)), this, SLOT(ircUserNickChanged(QString)));
-
-        _ircUsers[nick] = ircuser;
+        IrcUser *ircuser = createIrcUser(nick, hostmask, initData);
 
         // This method will be called with a nick instead of hostmask by setInitIrcUsersAndChannels().
         // Not a problem because initData contains all we need; however, making sure here to get the real
@@ -334,21 +402,57 @@ IrcUser *Network::newIrcUser(const QString &hostmask, const QVariantMap &initDat
 }
 
 
-IrcUser *Network::ircUser(QString nickname) const
+QList<IrcUser *> Network::newIrcUsers(const QStringList &hostmasks)
+{
+    QList<IrcUser *> users;
+    users.reserve(hostmasks.count());
+    foreach(const QString &hostmask, hostmasks) {
+        QString nick(ircLower(nickFromMask(hostmask)));
+        IrcUser *ircuser = _ircUsers.value(nick);
+        if (!ircuser) {
+            ircuser = createIrcUser(nick, hostmask, QVariantMap());
+            emit ircUserAdded(ircuser);
+        }
+        users << ircuser;
+    }
+    return users;
+}
+
+
+IrcUser *Network::createIrcUser(const QString &nick, const QString &hostmask, const QVariantMap &initData)
 {
-    nickname = nickname.toLower();
-    if (_ircUsers.contains(nickname))
-        return _ircUsers[nickname];
+    IrcUser *ircuser = ircUserFactory(hostmask);
+    if (!initData.isEmpty()) {
+        ircuser->fromVariantMap(initData);
+        ircuser->setInitialized();
+    }
+
+    if (proxy())
+        proxy()->synchronize(ircuser);
     else
-        return 0;
+        qWarning() << "unable to synchronize new IrcUser" << hostmask << "forgot to call Network::setProxy(SignalProxy *)?";
+
+    _ircUsers[nick] = ircuser;
+    return ircuser;
+}
+
+
+IrcUser *Network::ircUser(QString nickname) const
+{
+    return _ircUsers.value(ircLower(nickname), 0);
 }
 
 
 void Network::removeIrcUser(IrcUser *ircuser)
 {
-    QString nick = _ircUsers.key(ircuser);
-    if (nick.isNull())
-        return;
+    // Users are keyed by their lowercase nick; only fall back to searching the whole hash if that
+    // doesn't lead back to this user
+    QString nick = ircLower(ircuser->nick());
+    if (_ircUsers.value(nick) != ircuser) {
+        nick = _ircUsers.key(ircuser);
+        if (nick.isNull())
+            return;
+    }
 
     _ircUsers.remove(nick);
     disconnect(ircuser, 0, this, 0);
@@ -358,9 +462,12 @@ void Network::removeIrcUser(IrcUser *ircuser)
 
 void Network::removeIrcChannel(IrcChannel *channel)
 {
-    QString chanName = _ircChannels.key(channel);
-    if (chanName.isNull())
-        return;
+    QString chanName = ircLower(channel->name());
+    if (_ircChannels.value(chanName) != channel) {
+        chanName = _ircChannels.key(channel);
+        if (chanName.isNull())
+            return;
+    }
 
     _ircChannels.remove(chanName);
     disconnect(channel, 0, this, 0);
@@ -382,7 +489,8 @@ void Network::removeChansAndUsers()
 
 IrcChannel *Network::newIrcChannel(const QString &channelname, const QVariantMap &initData)
 {
-    if (!_ircChannels.contains(channelname.toLower())) {
+    QString key = ircLower(channelname);
+    if (!_ircChannels.contains(key)) {
         IrcChannel *channel = ircChannelFactory(channelname);
         if (!initData.isEmpty()) {
             channel->fromVariantMap(initData);
@@ -394,23 +502,19 @@ IrcChannel *Network::newIrcChannel(const QString &channelname, const QVariantMap
         else
             qWarning() << "unable to synchronize new IrcChannel" << channelname << "forgot to call Network::setProxy(SignalProxy *)?";
 
-        _ircChannels[channelname.toLower()] = channel;
+        _ircChannels[key] = channel;
 
         SYNC_OTHER(addIrcChannel, ARG(channelname))
         // emit ircChannelAdded(channelname);
         emit ircChannelAdded(channel);
     }
-    return _ircChannels[channelname.toLower()];
+    return _ircChannels[key];
 }
 
 
 IrcChannel *Network::ircChannel(QString channelname) const
 {
-    channelname = channelname.toLower();
-    if (_ircChannels.contains(channelname))
-        return _ircChannels[channelname];
-    else
-        return 0;
+    return _ircChannels.value(ircLower(channelname), 0);
 }
 
 
@@ -816,6 +920,8 @@ void Network::addSupport(const QString &param, const QString &value)
 {
     if (!_supports.contains(param)) {
         _supports[param] = value;
+        if (param == "CASEMAPPING")
+            updateCaseMapping();
         SYNC(ARG(param), ARG(value))
     }
 }
@@ -825,6 +931,8 @@ void Network::removeSupport(const QString &param)
 {
     if (_supports.contains(param)) {
         _supports.remove(param);
+        if (param == "CASEMAPPING")
+            updateCaseMapping();
         SYNC(ARG(param))
     }
 }
@@ -1072,7 +1180,7 @@ void Network::initSetCaps(const QVariantMap &caps)
 
 IrcUser *Network::updateNickFromMask(const QString &mask)
 {
-    QString nick(nickFromMask(mask).toLower());
+    QString nick(ircLower(nickFromMask(mask)));
     IrcUser *ircuser;
 
     if (_ircUsers.contains(nick)) {
@@ -1086,16 +1194,18 @@ IrcUser *Network::updateNickFromMask(const QString &mask)
 }
 
 
-void Network::ircUserNickChanged(QString newnick)
+void Network::ircUserNickChanged(IrcUser *ircuser, const QString &oldNick)
 {
-    QString oldnick = _ircUsers.key(qobject_cast<IrcUser *>(sender()));
+    QString oldnick = ircLower(oldNick);
 
-    if (oldnick.isNull())
+    // Not (yet) known under its old nick, e.g. while being set up in newIrcUser()
+    if (_ircUsers.value(oldnick) != ircuser)
         return;
 
-    if (newnick.toLower() != oldnick) _ircUsers[newnick.toLower()] = _ircUsers.take(oldnick);
+    QString newnick = ircuser->nick();
+    if (ircLower(newnick) != oldnick) _ircUsers[ircLower(newnick)] = _ircUsers.take(oldnick);
 
-    if (myNick().toLower() == oldnick)
+    if (ircLower(myNick()) == oldnick)
         setMyNick(newnick);
 }
 
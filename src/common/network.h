@@ -112,6 +112,15 @@ public :
         PORT_SSL = 6697        /// Default port for encrypted connections
     };
 
+    // Case mapping announced via RPL_ISUPPORT CASEMAPPING, rfc1459 if not given
+    // See http://www.irc.org/tech_docs/draft-brocklesby-irc-isupport-03.txt
+    enum CaseMapping {
+        AsciiCaseMapping,         /// Only A-Z map to a-z
+        Rfc1459CaseMapping,       /// Additionally []\~ map to {}|^
+        StrictRfc1459CaseMapping, /// Additionally []\ map to {}|
+        UnicodeCaseMapping        /// Unknown mapping, fall back to QString::toLower()
+    };
+
     struct Server {
         QString host;
         uint port;
@@ -151,8 +160,21 @@ public :
     inline SignalProxy *proxy() const { return _proxy; }
     inline void setProxy(SignalProxy *proxy) { _proxy = proxy; }
 
-    inline bool isMyNick(const QString &nick) const { return (myNick().toLower() == nick.toLower()); }
-    inline bool isMe(IrcUser *ircuser) const { return (ircuser->nick().toLower() == myNick().toLower()); }
+    inline bool isMyNick(const QString &nick) const { return (ircLower(myNick()) == ircLower(nick)); }
+    inline bool isMe(IrcUser *ircuser) const { return (ircLower(ircuser->nick()) == ircLower(myNick())); }
+
+    inline CaseMapping caseMapping() const { return _caseMapping; }
+
+    /**
+     * Folds the case of a nick or channel name according to the server's case mapping
+     *
+     * This is the key used for looking up IrcUsers and IrcChannels.  Names that are already folded
+     * are returned as-is without allocating a new string.
+     *
+     * @param[in] name  Nick or channel name
+     * @return Case-folded name
+     */
+    QString ircLower(const QString &name) const;
 
     bool isChannelName(const QString &channelname) const;
 
@@ -371,6 +393,16 @@ public :
 
     IrcUser *newIrcUser(const QString &hostmask, const QVariantMap &initData = QVariantMap());
     inline IrcUser *newIrcUser(const QByteArray &hostmask) { return newIrcUser(decodeServerString(hostmask)); }
+    /**
+     * Gets the IrcUsers for the given hostmasks, creating missing ones in bulk
+     *
+     * Unlike newIrcUser(), newly created users are not announced one by one via addIrcUser.  This
+     * is meant for channel joins, where the following joinIrcUsers sync makes clients create them.
+     *
+     * @param[in] hostmasks  Nicks or full nick!user@host masks
+     * @return IrcUsers in the same order as the given hostmasks
+     */
+    QList<IrcUser *> newIrcUsers(const QStringList &hostmasks);
     IrcUser *ircUser(QString nickname) const;
     inline IrcUser *ircUser(const QByteArray &nickname) const { return ircUser(decodeServerString(nickname)); }
     inline QList<IrcUser *> ircUsers() const { return _ircUsers.values(); }
@@ -564,10 +596,6 @@ public slots:
      */
     IrcUser *updateNickFromMask(const QString &mask);
 
-    // these slots are to keep the hashlists of all users and the
-    // channel lists up to date
-    void ircUserNickChanged(QString newnick);
-
     virtual inline void requestConnect() const { REQUEST(NO_ARG) }
     virtual inline void requestDisconnect() const { REQUEST(NO_ARG) }
     virtual inline void requestSetNetworkInfo(const NetworkInfo &info) { REQUEST(ARG(info)) }
@@ -692,6 +720,15 @@ protected:
     inline virtual IrcUser *ircUserFactory(const QString &hostmask) { return new IrcUser(hostmask, this); }
 
 private:
+    //! Creates, synchronizes and registers a user not yet known under the given lowercase nick
+    IrcUser *createIrcUser(const QString &nick, const QString &hostmask, const QVariantMap &initData);
+
+    //! Pick up a changed CASEMAPPING support, rekeying known users and channels if needed
+    void updateCaseMapping();
+
+    //! Called by IrcUser::setNick() to keep the nick hash up to date
+    void ircUserNickChanged(IrcUser *ircuser, const QString &oldNick);
+
     QPointer<SignalProxy> _proxy;
 
     NetworkId _networkId;
@@ -710,6 +747,7 @@ private:
     QHash<QString, IrcUser *> _ircUsers; // stores all known nicks for the server
     QHash<QString, IrcChannel *> _ircChannels; // stores all known channels
     QHash<QString, QString> _supports; // stores results from RPL_ISUPPORT
+    CaseMapping _caseMapping;          // parsed from the CASEMAPPING support
 
     QHash<QString, QString> _caps;  /// Capabilities supported by the IRC server
     // By synchronizing the supported capabilities, the client could suggest certain behaviors, e.g.
@@ -84,6 +84,11 @@ private:
 };
 
 
+//! Raw data received from a network
+/**
+  For NetworkIncoming, the data holds one or more complete lines as read from the socket, each
+  terminated by "\n" or "\r\n".
+ */
 class NetworkDataEvent : public NetworkEvent
 {
 public:
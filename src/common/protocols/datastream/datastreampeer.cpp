@@ -95,6 +95,7 @@ void DataStreamPeer::writeMessage(const QVariantList &sigProxyMsg)
     msgStream.setVersion(QDataStream::Qt_4_2);
     msgStream << sigProxyMsg;
 
+    shareFrame(data);
     writeMessage(data);
 }
 
@@ -325,9 +326,30 @@ void DataStreamPeer::handlePackedFunc(const QVariantList &packedFunc)
             QByteArray className = params.takeFirst().toByteArray();
             QString objectName = QString::fromUtf8(params.takeFirst().toByteArray());
             QByteArray slotName = params.takeFirst().toByteArray();
+            // Each call sent by name implicitly assigns the next id, see dispatch(SyncMessage).
+            // The sender resets before exceeding the cap, so this only guards against broken peers.
+            if (hasFeature(Quassel::Feature::SyncTargetIds) && _receivedSyncTargets.count() < maxSyncTargetIds)
+                _receivedSyncTargets.append({className, objectName, slotName});
             handle(Protocol::SyncMessage(className, objectName, slotName, params));
             break;
         }
+        case SyncById: {
+            if (params.isEmpty() || !hasFeature(Quassel::Feature::SyncTargetIds)) {
+                qWarning() << Q_FUNC_INFO << "Received invalid sync call:" << params;
+                return;
+            }
+            int id = params.takeFirst().toInt();
+            if (id < 0 || id >= _receivedSyncTargets.count()) {
+                qWarning() << Q_FUNC_INFO << "Received sync call for unknown target id:" << id;
+                return;
+            }
+            const SyncTarget &target = _receivedSyncTargets.at(id);
+            handle(Protocol::SyncMessage(target.className, target.objectName, target.slotName, params));
+            break;
+        }
+        case SyncTargetsReset:
+            _receivedSyncTargets.clear();
+            break;
         case RpcCall: {
             if (params.empty()) {
                 qWarning() << Q_FUNC_INFO << "Received empty RPC call!";
@@ -385,18 +407,51 @@ void DataStreamPeer::handlePackedFunc(const QVariantList &packedFunc)
 
 void DataStreamPeer::dispatch(const Protocol::SyncMessage &msg)
 {
+    if (hasFeature(Quassel::Feature::SyncTargetIds)) {
+        // The first call to a target goes out by name and assigns it the next id on both ends;
+        // afterwards only the id is sent.  Ids are specific to this connection, so unlike other
+        // messages the resulting frame can't be shared with other peers.
+        QByteArray objectName = msg.objectName.toUtf8();
+        QByteArray key = msg.className + '\0' + msg.slotName + '\0' + objectName;
+        QVariantList packedFunc;
+        auto it = _sentSyncTargetIds.constFind(key);
+        if (it != _sentSyncTargetIds.constEnd()) {
+            packedFunc << (qint16)SyncById << *it << msg.params;
+        }
+        else {
+            // Start over rather than keep ids of targets that may long be gone
+            if (_sentSyncTargetIds.count() >= maxSyncTargetIds) {
+                writeUnsharedPackedFunc(QVariantList() << (qint16)SyncTargetsReset);
+                _sentSyncTargetIds.clear();
+            }
+            _sentSyncTargetIds.insert(key, _sentSyncTargetIds.count());
+            packedFunc << (qint16)Sync << msg.className << objectName << msg.slotName << msg.params;
+        }
+        writeUnsharedPackedFunc(packedFunc);
+        return;
+    }
+
+    if (writeSharedFrame())
+        return;
+
     dispatchPackedFunc(QVariantList() << (qint16)Sync << msg.className << msg.objectName.toUtf8() << msg.slotName << msg.params);
 }
 
 
 void DataStreamPeer::dispatch(const Protocol::RpcCall &msg)
 {
+    if (writeSharedFrame())
+        return;
+
     dispatchPackedFunc(QVariantList() << (qint16)RpcCall << msg.slotName << msg.params);
 }
 
 
 void DataStreamPeer::dispatch(const Protocol::InitRequest &msg)
 {
+    if (writeSharedFrame())
+        return;
+
     dispatchPackedFunc(QVariantList() << (qint16)InitRequest << msg.className << msg.objectName.toUtf8());
 }
 
@@ -429,3 +484,14 @@ void DataStreamPeer::dispatchPackedFunc(const QVariantList &packedFunc)
 {
     writeMessage(packedFunc);
 }
+
+
+void DataStreamPeer::writeUnsharedPackedFunc(const QVariantList &packedFunc)
+{
+    // Unlike writeMessage(), don't offer the frame to other peers of the current broadcast
+    QByteArray data;
+    QDataStream msgStream(&data, QIODevice::WriteOnly);
+    msgStream.setVersion(QDataStream::Qt_4_2);
+    msgStream << packedFunc;
+    writeMessage(data);
+}
@@ -21,6 +21,9 @@
 #ifndef DATASTREAMPEER_H
 #define DATASTREAMPEER_H
 
+#include <QHash>
+#include <QVector>
+
 #include "../../remotepeer.h"
 
 class QDataStream;
@@ -36,7 +39,9 @@ public:
         InitRequest,
         InitData,
         HeartBeat,
-        HeartBeatReply
+        HeartBeatReply,
+        SyncById,           ///< Sync call to a target announced by an earlier Sync (SyncTargetIds)
+        SyncTargetsReset    ///< Drops all sync target ids, so they can be assigned anew (SyncTargetIds)
     };
 
     DataStreamPeer(AuthHandler *authHandler, QTcpSocket *socket, quint16 features, Compressor::CompressionLevel level, QObject *parent = 0);
@@ -79,6 +84,26 @@ private:
     void handleHandshakeMessage(const QVariantList &mapData);
     void handlePackedFunc(const QVariantList &packedFunc);
     void dispatchPackedFunc(const QVariantList &packedFunc);
+    void writeUnsharedPackedFunc(const QVariantList &packedFunc);
+
+    //! Target of a sync call, as announced by the first Sync message sent for it
+    struct SyncTarget {
+        QByteArray className;
+        QString objectName;
+        QByteArray slotName;
+    };
+
+    //! Number of sync target ids after which the sender resets the tables on both ends
+    /** Ids are never released individually, so targets that are gone (e.g. IrcUsers that quit or were
+     *  renamed on a nick change) keep their entries until the next reset. Once the cap is reached, the
+     *  sender sends SyncTargetsReset and starts over; targets still in use get announced by name once
+     *  more. This bounds both tables, and the cost of a reset is negligible compared to the calls
+     *  that 64k ids save.
+     */
+    static const int maxSyncTargetIds = 65536;
+
+    QHash<QByteArray, int> _sentSyncTargetIds;        ///< Ids of targets announced to the peer
+    QVector<SyncTarget> _receivedSyncTargets;         ///< Targets announced by the peer, by id
 };
 
 #endif
@@ -126,6 +126,7 @@ void LegacyPeer::writeMessage(const QVariant &item)
         out << item;
     }
 
+    shareFrame(block);
     writeMessage(block);
 }
 
@@ -461,18 +462,27 @@ void LegacyPeer::handlePackedFunc(const QVariant &packedFunc)
 
 void LegacyPeer::dispatch(const Protocol::SyncMessage &msg)
 {
+    if (writeSharedFrame())
+        return;
+
     dispatchPackedFunc(QVariantList() << (qint16)Sync << msg.className << msg.objectName << msg.slotName << msg.params);
 }
 
 
 void LegacyPeer::dispatch(const Protocol::RpcCall &msg)
 {
+    if (writeSharedFrame())
+        return;
+
     dispatchPackedFunc(QVariantList() << (qint16)RpcCall << msg.slotName << msg.params);
 }
 
 
 void LegacyPeer::dispatch(const Protocol::InitRequest &msg)
 {
+    if (writeSharedFrame())
+        return;
+
     dispatchPackedFunc(QVariantList() << (qint16)InitRequest << msg.className << msg.objectName);
 }
 
@@ -502,6 +512,13 @@ void LegacyPeer::dispatch(const Protocol::HeartBeatReply &msg)
 }
 
 
+bool LegacyPeer::hasSameEncoding(const RemotePeer *other) const
+{
+    // the legacy protocol compresses each message on its own
+    return RemotePeer::hasSameEncoding(other) && _useCompression == static_cast<const LegacyPeer *>(other)->_useCompression;
+}
+
+
 void LegacyPeer::dispatchPackedFunc(const QVariantList &packedFunc)
 {
     writeMessage(QVariant(packedFunc));
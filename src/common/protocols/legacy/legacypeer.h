@@ -44,6 +44,8 @@ public:
 
     void setSignalProxy(SignalProxy *proxy);
 
+    bool hasSameEncoding(const RemotePeer *other) const;
+
     void dispatch(const Protocol::RegisterClient &msg);
     void dispatch(const Protocol::ClientDenied &msg);
     void dispatch(const Protocol::ClientRegistered &msg);
@@ -142,6 +142,10 @@ public:
 #endif
         LongMessageId,            ///< 64-bit IDs for messages
         SyncedCoreInfo,           ///< CoreInfo dynamically updated using signals
+        BacklogColumnar,          ///< Backlog sent as a single columnar MessageBlock
+        SyncTargetIds,            ///< Repeated sync calls refer to their target by a numeric id
+        BacklogSearch,            ///< Full-text search of the backlog stored in the core
+        BacklogRequestMulti,      ///< Backlog for several buffers requested at once, replied to per buffer
     };
     Q_ENUMS(Feature)
 
@@ -337,6 +341,9 @@ public:
      */
     QStringList unknownFeatures() const;
 
+    bool operator==(const Features &other) const { return _features == other._features; }
+    bool operator!=(const Features &other) const { return !(*this == other); }
+
 private:
     std::vector<bool> _features;
     QStringList _unknownFeatures;
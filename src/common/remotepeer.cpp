@@ -266,6 +266,31 @@ void RemotePeer::writeMessage(const QByteArray &msg)
 }
 
 
+bool RemotePeer::hasSameEncoding(const RemotePeer *other) const
+{
+    return protocol() == other->protocol() && features() == other->features();
+}
+
+
+bool RemotePeer::writeSharedFrame()
+{
+    QByteArray frame;
+    if (!signalProxy() || !signalProxy()->sharedFrame(this, frame))
+        return false;
+
+    // Note that compression state is per connection, so compression still happens for each peer
+    writeMessage(frame);
+    return true;
+}
+
+
+void RemotePeer::shareFrame(const QByteArray &frame)
+{
+    if (signalProxy())
+        signalProxy()->shareFrame(this, frame);
+}
+
+
 void RemotePeer::handle(const HeartBeat &heartBeat)
 {
     dispatch(HeartBeatReply(heartBeat.timestamp));
@@ -63,6 +63,9 @@ public:
 
     QTcpSocket *socket() const;
 
+    //! Whether the other peer serializes messages into exactly the same frames as this one
+    virtual bool hasSameEncoding(const RemotePeer *other) const;
+
 public slots:
     void close(const QString &reason = QString());
 
@@ -77,6 +80,11 @@ protected:
     void writeMessage(const QByteArray &msg);
     virtual void processMessage(const QByteArray &msg) = 0;
 
+    //! Writes the frame another peer has serialized for the message currently being broadcast, if any
+    bool writeSharedFrame();
+    //! Makes a serialized frame available to the other peers of the current broadcast
+    void shareFrame(const QByteArray &frame);
+
     // These protocol messages get handled internally and won't reach SignalProxy
     void handle(const Protocol::HeartBeat &heartBeat);
     void handle(const Protocol::HeartBeatReply &heartBeatReply);
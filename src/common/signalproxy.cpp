@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include <QCoreApplication>
+#include <QDataStream>
 #include <QHostAddress>
 #include <QMetaMethod>
 #include <QMetaProperty>
@@ -32,6 +33,7 @@
 
 #include "peer.h"
 #include "protocol.h"
+#include "remotepeer.h"
 #include "syncableobject.h"
 #include "util.h"
 #include "types.h"
@@ -235,6 +237,8 @@ void SignalProxy::init()
     setMaxHeartBeatCount(2);
     _secure = false;
     _current = this;
+    _coalescingTimer.setSingleShot(true);
+    connect(&_coalescingTimer, SIGNAL(timeout()), this, SLOT(flushCoalescedSyncs()));
     updateSecureState();
 }
 
@@ -268,6 +272,14 @@ void SignalProxy::setMaxHeartBeatCount(int max)
 }
 
 
+void SignalProxy::setSyncCoalescingInterval(int msecs)
+{
+    _syncCoalescingInterval = qMax(msecs, 0);
+    if (!_syncCoalescingInterval)
+        flushCoalescedSyncs();
+}
+
+
 bool SignalProxy::addPeer(Peer *peer)
 {
     if (!peer)
@@ -504,6 +516,9 @@ void SignalProxy::detachSlots(QObject *receiver)
 
 void SignalProxy::stopSynchronize(SyncableObject *obj)
 {
+    // Don't leave updates for the object behind
+    flushCoalescedSyncs();
+
     // we can't use a className here, since it might be effed up, if we receive the call as a result of a decon
     // gladly the objectName() is still valid. So we have only to iterate over the classes not each instance! *sigh*
     QHash<QByteArray, ObjectId>::iterator classIter = _syncSlave.begin();
@@ -521,15 +536,27 @@ void SignalProxy::stopSynchronize(SyncableObject *obj)
 template<class T>
 void SignalProxy::dispatch(const T &protoMessage)
 {
+    // Coalesced sync calls must not overtake the messages that follow them
+    if (!_pendingSyncs.isEmpty())
+        flushCoalescedSyncs();
+
+    // Peers speaking the same protocol with the same features produce identical frames, so only
+    // the first one of them needs to serialize the message
+    QList<SharedFrame> sharedFrames;
+    _sharedFrames = &sharedFrames;
     for (auto&& peer : _peerMap.values()) {
         dispatch(peer, protoMessage);
     }
+    _sharedFrames = nullptr;
 }
 
 
 template<class T>
 void SignalProxy::dispatch(Peer *peer, const T &protoMessage)
 {
+    if (!_pendingSyncs.isEmpty())
+        flushCoalescedSyncs();
+
     _targetPeer = peer;
 
     if (peer && peer->isOpen())
@@ -781,8 +808,53 @@ void SignalProxy::sync_call__(const SyncableObject *obj, SignalProxy::ProxyMode
             if (peer != nullptr)
                 dispatch(peer, SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
         }
-    } else
-        dispatch(SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
+    }
+    else {
+        int keyArgCount = eMeta->coalescedKeyArgCount(QByteArray(funcname));
+        if (keyArgCount >= 0 && _syncCoalescingInterval > 0)
+            coalesceSync(SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params), keyArgCount);
+        else
+            dispatch(SyncMessage(eMeta->metaObject()->className(), obj->objectName(), QByteArray(funcname), params));
+    }
+}
+
+
+void SignalProxy::coalesceSync(const SyncMessage &syncMessage, int keyArgCount)
+{
+    QByteArray key;
+    QDataStream keyStream(&key, QIODevice::WriteOnly);
+    keyStream << syncMessage.className << syncMessage.objectName << syncMessage.slotName;
+    for (int i = 0; i < keyArgCount && i < syncMessage.params.count(); ++i)
+        keyStream << syncMessage.params.at(i);
+
+    auto it = _pendingSyncIndex.constFind(key);
+    if (it != _pendingSyncIndex.constEnd()) {
+        // Last writer wins, but keeps the position of the call it replaces
+        _pendingSyncs[*it] = syncMessage;
+        ++_coalescedSyncCount;
+        return;
+    }
+
+    _pendingSyncIndex.insert(key, _pendingSyncs.count());
+    _pendingSyncs.append(syncMessage);
+    if (_pendingSyncs.count() >= maxPendingSyncs)
+        flushCoalescedSyncs();
+    else if (!_coalescingTimer.isActive())
+        _coalescingTimer.start(_syncCoalescingInterval);
+}
+
+
+void SignalProxy::flushCoalescedSyncs()
+{
+    _coalescingTimer.stop();
+    if (_pendingSyncs.isEmpty())
+        return;
+
+    QList<SyncMessage> pendingSyncs;
+    pendingSyncs.swap(_pendingSyncs);
+    _pendingSyncIndex.clear();
+    for (const SyncMessage &syncMessage : pendingSyncs)
+        dispatch(syncMessage);
 }
 
 
@@ -814,6 +886,33 @@ void SignalProxy::dumpProxyStats()
     qDebug() << "          attached Slots:" << _attachedSlots.count();
     qDebug() << " number of synced Slaves:" << slaveCount;
     qDebug() << "number of Classes cached:" << _extendedMetaObjects.count();
+    qDebug() << "       frames serialized:" << _serializedFrameCount;
+    qDebug() << "           frames shared:" << _sharedFrameCount;
+    qDebug() << "         syncs coalesced:" << _coalescedSyncCount;
+}
+
+
+bool SignalProxy::sharedFrame(const RemotePeer *peer, QByteArray &frame)
+{
+    if (!_sharedFrames)
+        return false;
+
+    for (const SharedFrame &sharedFrame : *_sharedFrames) {
+        if (sharedFrame.peer->hasSameEncoding(peer)) {
+            frame = sharedFrame.frame;
+            ++_sharedFrameCount;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void SignalProxy::shareFrame(const RemotePeer *peer, const QByteArray &frame)
+{
+    ++_serializedFrameCount;
+    if (_sharedFrames)
+        _sharedFrames->append({peer, frame});
 }
 
 
@@ -939,6 +1038,17 @@ SignalProxy::ExtendedMetaObject::ExtendedMetaObject(const QMetaObject *meta, boo
         }
         _methodIds[method] = i;
     }
+
+    int coalescedSyncsIndex = _meta->indexOfClassInfo("CoalescedSyncs");
+    if (coalescedSyncsIndex != -1) {
+        foreach(const QByteArray &entry, QByteArray(_meta->classInfo(coalescedSyncsIndex).value()).split(' ')) {
+            if (entry.isEmpty())
+                continue;
+            int separatorPos = entry.indexOf(':');
+            int keyArgCount = separatorPos == -1 ? 0 : entry.mid(separatorPos + 1).toInt();
+            _coalescedKeyArgCounts[entry.left(separatorPos)] = keyArgCount;
+        }
+    }
 }
 
 
@@ -22,6 +22,7 @@
 
 #include <QEvent>
 #include <QSet>
+#include <QTimer>
 
 #include <functional>
 #include <initializer_list>
@@ -32,6 +33,7 @@ struct QMetaObject;
 class QIODevice;
 
 class Peer;
+class RemotePeer;
 class SyncableObject;
 
 class SignalProxy : public QObject
@@ -62,6 +64,18 @@ public:
     void setMaxHeartBeatCount(int max);
     inline int maxHeartBeatCount() const { return _maxHeartBeatCount; }
 
+    /**
+     * Sets how long sync calls to slots marked as coalesced are held back before being sent
+     *
+     * Slots are marked by listing them in the "CoalescedSyncs" class info of their SyncableObject,
+     * as "slotName:keyArgCount" separated by spaces. Pending calls to the same object and slot whose
+     * first keyArgCount arguments are equal replace each other, so only the latest one is sent.
+     *
+     * @param msecs The coalescing window in milliseconds, or 0 to send all sync calls immediately
+     */
+    void setSyncCoalescingInterval(int msecs);
+    inline int syncCoalescingInterval() const { return _syncCoalescingInterval; }
+
     bool addPeer(Peer *peer);
 
     bool attachSignal(QObject *sender, const char *signal, const QByteArray &sigName = QByteArray());
@@ -124,6 +138,31 @@ public:
     Peer *targetPeer();
     void setTargetPeer(Peer *targetPeer);
 
+    /**
+     * While broadcasting a message, provides a frame serialized for a peer with the same encoding
+     *
+     * @param[in]  peer  The peer the message is about to be serialized for
+     * @param[out] frame The shared frame, if available
+     * @return Whether a frame could be shared
+     */
+    bool sharedFrame(const RemotePeer *peer, QByteArray &frame);
+
+    /**
+     * Makes a frame serialized for the given peer available to the other peers of the current broadcast
+     */
+    void shareFrame(const RemotePeer *peer, const QByteArray &frame);
+
+    /**
+     * @return The number of frames serialized, and the number of frames reused across peers
+     */
+    inline quint64 serializedFrameCount() const { return _serializedFrameCount; }
+    inline quint64 sharedFrameCount() const { return _sharedFrameCount; }
+
+    /**
+     * @return The number of sync calls that were superseded by a later one before being sent
+     */
+    inline quint64 coalescedSyncCount() const { return _coalescedSyncCount; }
+
 public slots:
     void detachObject(QObject *obj);
     void detachSignals(QObject *sender);
@@ -135,6 +174,7 @@ protected:
     void renameObject(const SyncableObject *obj, const QString &newname, const QString &oldname);
 
 private slots:
+    void flushCoalescedSyncs();
     void removePeerBySender();
     void objectRenamed(const QByteArray &classname, const QString &newname, const QString &oldname);
     void updateSecureState();
@@ -171,6 +211,8 @@ private:
     template<class T>
     void dispatch(Peer *peer, const T &protoMessage);
 
+    void coalesceSync(const Protocol::SyncMessage &syncMessage, int keyArgCount);
+
     void handle(Peer *peer, const Protocol::SyncMessage &syncMessage);
     void handle(Peer *peer, const Protocol::RpcCall &rpcCall);
     void handle(Peer *peer, const Protocol::InitRequest &initRequest);
@@ -219,6 +261,22 @@ private:
     Peer *_sourcePeer = nullptr;
     Peer *_targetPeer = nullptr;
 
+    struct SharedFrame {
+        const RemotePeer *peer;
+        QByteArray frame;
+    };
+    QList<SharedFrame> *_sharedFrames = nullptr;  ///< Frames serialized during the current broadcast
+    quint64 _serializedFrameCount = 0;
+    quint64 _sharedFrameCount = 0;
+
+    static const int maxPendingSyncs = 256;  ///< Pending coalesced sync calls that trigger a flush
+
+    int _syncCoalescingInterval = 50;
+    QTimer _coalescingTimer;
+    QList<Protocol::SyncMessage> _pendingSyncs;  ///< Coalesced sync calls, in order of first occurrence
+    QHash<QByteArray, int> _pendingSyncIndex;    ///< Position of a pending call in _pendingSyncs, by coalescing key
+    quint64 _coalescedSyncCount = 0;
+
     thread_local static SignalProxy *_current;
 
     friend class SignalRelay;
@@ -266,6 +324,9 @@ public:
 
     inline int updatedRemotelyId() { return _updatedRemotelyId; }
 
+    //! Number of leading arguments identifying what a coalesced slot updates, or -1 if it isn't coalesced
+    inline int coalescedKeyArgCount(const QByteArray &methodName) const { return _coalescedKeyArgCounts.value(methodName, -1); }
+
     inline const QHash<QByteArray, int> &slotMap() { return _methodIds; }
     const QHash<int, int> &receiveMap();
 
@@ -283,4 +344,5 @@ private:
     QHash<int, MethodDescriptor> _methods;
     QHash<QByteArray, int> _methodIds;
     QHash<int, int> _receiveMap; // if slot x is called then hand over the result to slot y
+    QHash<QByteArray, int> _coalescedKeyArgCounts; // from the "CoalescedSyncs" class info
 };
@@ -0,0 +1,3 @@
+SELECT bufferid, lastseenmsgid, markerlinemsgid, bufferactivity, highlightcount
+FROM buffer
+WHERE userid = :userid
@@ -0,0 +1,7 @@
+SELECT messageid
+FROM backlog
+WHERE to_tsvector('simple', message) @@ plainto_tsquery('simple', $1)
+    AND bufferid = $2
+    AND messageid < $3
+ORDER BY messageid DESC
+LIMIT $4
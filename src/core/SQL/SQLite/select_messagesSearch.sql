@@ -0,0 +1,8 @@
+SELECT backlog.messageid
+FROM backlog_fts
+JOIN backlog ON backlog.messageid = backlog_fts.docid
+WHERE backlog_fts MATCH :query
+    AND backlog.bufferid = :bufferid
+    AND backlog.messageid < :lastmsg
+ORDER BY backlog.messageid DESC
+LIMIT :limit
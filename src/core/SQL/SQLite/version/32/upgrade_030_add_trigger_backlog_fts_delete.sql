@@ -0,0 +1,8 @@
+CREATE TRIGGER IF NOT EXISTS backlog_fts_trigger_delete
+BEFORE DELETE
+ON backlog
+FOR EACH ROW
+    BEGIN
+        DELETE FROM backlog_fts
+        WHERE docid = old.messageid;
+    END
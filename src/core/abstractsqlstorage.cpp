@@ -45,6 +45,9 @@ AbstractSqlStorage::~AbstractSqlStorage()
         QSqlDatabase::removeDatabase(conIter.value()->name());
         disconnect(conIter.value(), 0, this, 0);
     }
+
+    if (Quassel::isOptionSet("debug"))
+        qDebug() << "Sender id cache:" << _senderIdCache.hits() << "hits," << _senderIdCache.misses() << "misses";
 }
 
 
@@ -642,3 +645,64 @@ bool operator==(const SenderData &a, const SenderData &b) {
         a.realname == b.realname &&
         a.avatarurl == b.avatarurl;
 }
+
+
+// ========================================
+//  SenderIdCache
+// ========================================
+SenderIdCache::SenderIdCache(int maxBytes)
+    : _cache(maxBytes),
+    _hits(0),
+    _misses(0)
+{
+}
+
+
+qint64 SenderIdCache::senderId(const SenderData &sender)
+{
+    QMutexLocker locker(&_mutex);
+    qint64 *senderId = _cache.object(sender);
+    if (!senderId) {
+        _misses++;
+        return -1;
+    }
+    _hits++;
+    return *senderId;
+}
+
+
+void SenderIdCache::insert(const SenderData &sender, qint64 senderId)
+{
+    QMutexLocker locker(&_mutex);
+    _cache.insert(sender, new qint64(senderId), cost(sender));
+}
+
+
+void SenderIdCache::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _cache.clear();
+}
+
+
+quint64 SenderIdCache::hits() const
+{
+    QMutexLocker locker(&_mutex);
+    return _hits;
+}
+
+
+quint64 SenderIdCache::misses() const
+{
+    QMutexLocker locker(&_mutex);
+    return _misses;
+}
+
+
+int SenderIdCache::cost(const SenderData &sender)
+{
+    // The key is stored twice (in the hash and in the LRU list), plus the value and some
+    // bookkeeping; this is only meant to be a rough estimate.
+    int strings = sender.sender.size() + sender.realname.size() + sender.avatarurl.size();
+    return 2 * (int(sizeof(SenderData)) + 2 * strings) + int(sizeof(qint64)) + 64;
+}
@@ -24,6 +24,8 @@
 
 #include <memory>
 
+#include <QCache>
+#include <QMutex>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -31,6 +33,46 @@
 class AbstractSqlMigrationReader;
 class AbstractSqlMigrationWriter;
 
+struct SenderData {
+    QString sender;
+    QString realname;
+    QString avatarurl;
+
+    friend uint qHash(const SenderData &key);
+    friend bool operator==(const SenderData &a, const SenderData &b);
+};
+
+
+// ========================================
+//  SenderIdCache
+// ========================================
+//! A thread-safe LRU cache mapping sender tuples to their senderid
+/** The cache is bounded by the (estimated) memory its entries occupy. Only add senderids here
+ *  once they are committed to the database, since other threads may pick them up right away.
+ */
+class SenderIdCache
+{
+public:
+    SenderIdCache(int maxBytes = 4 * 1024 * 1024);
+
+    //! Returns the cached senderid for the given sender, or -1 if it is not cached
+    qint64 senderId(const SenderData &sender);
+    void insert(const SenderData &sender, qint64 senderId);
+    void clear();
+
+    quint64 hits() const;
+    quint64 misses() const;
+
+private:
+    static int cost(const SenderData &sender);
+
+    mutable QMutex _mutex;
+    QCache<SenderData, qint64> _cache;
+    quint64 _hits;
+    quint64 _misses;
+};
+
+
 class AbstractSqlStorage : public Storage
 {
     Q_OBJECT
@@ -42,6 +84,9 @@ public:
     virtual std::unique_ptr<AbstractSqlMigrationReader> createMigrationReader() { return {}; }
     virtual std::unique_ptr<AbstractSqlMigrationWriter> createMigrationWriter() { return {}; }
 
+    //! The cache of committed senderids shared by all connections of this storage
+    inline SenderIdCache &senderIdCache() { return _senderIdCache; }
+
 public slots:
     virtual State init(const QVariantMap &settings = QVariantMap(),
                        const QProcessEnvironment &environment = {},
@@ -115,6 +160,8 @@ private:
     int _schemaVersion;
     bool _debug;
 
+    SenderIdCache _senderIdCache;
+
     static int _nextConnectionId;
     QMutex _connectionPoolMutex;
     // we let a Connection Object manage each actual db connection
@@ -124,15 +171,6 @@ private:
     QHash<QThread *, Connection *> _connectionPool;
 };
 
-struct SenderData {
-    QString sender;
-    QString realname;
-    QString avatarurl;
-
-    friend uint qHash(const SenderData &key);
-    friend bool operator==(const SenderData &a, const SenderData &b);
-};
-
 // ========================================
 //  AbstractSqlStorage::Connection
 // ========================================
@@ -21,6 +21,7 @@
 #include <algorithm>
 
 #include <QCoreApplication>
+#include <QThreadPool>
 
 #include "core.h"
 #include "coreauthhandler.h"
@@ -33,6 +34,7 @@
 #include "quassel.h"
 #include "sqlauthenticator.h"
 #include "sqlitestorage.h"
+#include "storagewriter.h"
 #include "types.h"
 #include "util.h"
 
@@ -473,10 +475,40 @@ bool Core::initStorage(const QString &backend, const QVariantMap &settings,
         break;
     }
     _storage = std::move(storage);
+    createStorageWorkers();
     return true;
 }
 
 
+void Core::createStorageWorkers()
+{
+    _storageWriter.reset(new StorageWriter(_storage));
+    _backlogThreadPool.reset(new QThreadPool);
+    _backlogThreadPool->setMaxThreadCount(qBound(1, QThread::idealThreadCount(), 4));
+    // Threads hold on to their database connection, so keep them around rather than reconnecting
+    _backlogThreadPool->setExpiryTimeout(-1);
+}
+
+
+void Core::storeMessagesAsync(const MessageList &messages, QObject *receiver)
+{
+    instance()->_storageWriter->enqueue(messages, receiver);
+}
+
+
+void Core::flushStoredMessages(QObject *receiver)
+{
+    if (instance()->_storageWriter)
+        instance()->_storageWriter->flush(receiver);
+}
+
+
+void Core::runBacklogQuery(QRunnable *query)
+{
+    instance()->_backlogThreadPool->start(query);
+}
+
+
 void Core::syncStorage()
 {
     if (_storage)
@@ -980,6 +1012,8 @@ bool Core::selectBackend(const QString &backend)
     auto writer = getMigrationWriter(storage.get());
     if (reader && writer) {
         qDebug() << qPrintable(tr("Migrating storage backend %1 to %2...").arg(_storage->displayName(), storage->displayName()));
+        _backlogThreadPool.reset();
+        _storageWriter.reset();
         _storage.reset();
         storage.reset();
         if (reader->migrateTo(writer.get())) {
@@ -1008,6 +1042,7 @@ bool Core::selectBackend(const QString &backend)
 
     // so we were unable to merge, but let's create a user \o/
     _storage = std::move(storage);
+    createStorageWorkers();
     createUser();
     return true;
 }
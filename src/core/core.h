@@ -51,8 +51,11 @@
 class CoreAuthHandler;
 class CoreSession;
 class InternalPeer;
+class QRunnable;
+class QThreadPool;
 class SessionThread;
 class SignalProxy;
+class StorageWriter;
 
 struct NetworkInfo;
 
@@ -426,6 +429,32 @@ public:
     }
 
 
+    //! Store a list of Messages in the storage backend without waiting for the result.
+    /** The messages are written by the storage writer thread. Once they have been stored, a
+     *  MessagesStoredEvent carrying the messages with their unique Ids is posted to the receiver.
+     *  \note This method is threadsafe. It blocks while the storage queue is full.
+     *
+     *  \param messages The list message objects to be stored
+     *  \param receiver The object to be notified once the messages have been stored
+     */
+    static void storeMessagesAsync(const MessageList &messages, QObject *receiver);
+
+
+    //! Wait until all messages queued by the given receiver have been stored.
+    /** Must be called before the receiver is destroyed.
+     *  \note This method is threadsafe.
+     */
+    static void flushStoredMessages(QObject *receiver);
+
+
+    //! Run a backlog query in one of the backlog threads.
+    /** Each backlog thread keeps its own database connection, so queries don't wait for each other
+     *  or block the session thread that issued them. The pool takes ownership of the query.
+     *  \note This method is threadsafe.
+     */
+    static void runBacklogQuery(QRunnable *query);
+
+
     //! Request a certain number messages stored in a given buffer.
     /** \param buffer   The buffer we request messages from
      *  \param first    if != -1 return only messages with a MsgId >= first
@@ -482,6 +511,19 @@ public:
     }
 
 
+    //! Search the messages stored in a given buffer for a number of words
+    /** \param buffer   The buffer we search messages in
+     *  \param query    Whitespace-separated words that all have to occur in a message, ignoring case
+     *  \param last     if != -1 return only messages with a MsgId < last, for fetching the next page
+     *  \param limit    if != -1 limit the returned list to a max of \limit entries
+     *  \return The ids of the matching messages, newest first
+     */
+    static inline QList<MsgId> searchMsgs(UserId user, BufferId bufferId, const QString &query, MsgId last = -1, int limit = -1)
+    {
+        return instance()->_storage->searchMsgs(user, bufferId, query, last, limit);
+    }
+
+
     //! Request a list of all buffers known to a user.
     /** This method is used to get a list of all buffers we have stored a backlog from.
      *  \note This method is threadsafe.
@@ -673,6 +715,16 @@ public:
         return instance()->_storage->highlightCount(bufferId, lastSeenMsgId);
     }
 
+    //! Get the persistent state of all buffers of a user in one go
+    /** This Method is called when a session is started to restore the BufferSyncer state.
+     *  \note This method is threadsafe.
+     *
+     * \param user      The Owner of the buffers
+     */
+    static inline Storage::BufferStates bufferStates(UserId user) {
+        return instance()->_storage->bufferStates(user);
+    }
+
     static inline QDateTime startTime() { return instance()->_startTime; }
     static inline bool isConfigured() { return instance()->_configured; }
 
@@ -796,6 +848,8 @@ private:
     QSet<CoreAuthHandler *> _connectingClients;
     QHash<UserId, SessionThread *> _sessions;
     DeferredSharedPtr<Storage>       _storage;        ///< Active storage backend
+    std::unique_ptr<StorageWriter>   _storageWriter;  ///< Writes messages to the active storage backend
+    std::unique_ptr<QThreadPool>     _backlogThreadPool;  ///< Runs backlog queries, see runBacklogQuery()
     DeferredSharedPtr<Authenticator> _authenticator;  ///< Active authenticator
     QMap<UserId, QString> _authUserNames;
 
@@ -824,6 +878,8 @@ private:
     /// Whether or not strict ident mode is enabled, locking users' idents to Quassel username
     bool _strictIdentEnabled;
 
+    void createStorageWorkers();
+
     static std::unique_ptr<AbstractSqlMigrationReader> getMigrationReader(Storage *storage);
     static std::unique_ptr<AbstractSqlMigrationWriter> getMigrationWriter(Storage *storage);
     static void stdInEcho(bool on);
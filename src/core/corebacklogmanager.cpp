@@ -21,29 +21,31 @@
 #include "corebacklogmanager.h"
 #include "core.h"
 #include "coresession.h"
+#include "messageblock.h"
+#include "peer.h"
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QMutex>
+#include <QRunnable>
 
-INIT_SYNCABLE_OBJECT(CoreBacklogManager)
-CoreBacklogManager::CoreBacklogManager(CoreSession *coreSession)
-    : BacklogManager(coreSession),
-    _coreSession(coreSession)
+//! Target for the results of backlog queries, cleared once the manager is gone
+struct BacklogResultReceiver
 {
-}
+    QMutex mutex;
+    QObject *receiver;
+};
 
+namespace {
 
-QVariantList CoreBacklogManager::requestBacklog(BufferId bufferId, MsgId first, MsgId last, int limit, int additional)
+//! Fetches the backlog of a buffer, plus additional older messages if they continue seamlessly
+MessageList fetchBacklog(UserId user, BufferId bufferId, MsgId first, MsgId last, int limit, int additional)
 {
-    QVariantList backlog;
+    MessageList backlog;
     QList<Message> msgList;
-    msgList = Core::requestMsgs(coreSession()->user(), bufferId, first, last, limit);
+    msgList = Core::requestMsgs(user, bufferId, first, last, limit);
 
-    QList<Message>::const_iterator msgIter = msgList.constBegin();
-    QList<Message>::const_iterator msgListEnd = msgList.constEnd();
-    while (msgIter != msgListEnd) {
-        backlog << qVariantFromValue(*msgIter);
-        ++msgIter;
-    }
+    backlog << msgList;
 
     if (additional && limit != 0) {
         MsgId oldestMessage = first;
@@ -64,13 +66,8 @@ QVariantList CoreBacklogManager::requestBacklog(BufferId bufferId, MsgId first,
         // only fetch additional messages if they continue seemlessly
         // that is, if the list of messages is not truncated by the limit
         if (last == oldestMessage) {
-            msgList = Core::requestMsgs(coreSession()->user(), bufferId, -1, last, additional);
-            msgIter = msgList.constBegin();
-            msgListEnd = msgList.constEnd();
-            while (msgIter != msgListEnd) {
-                backlog << qVariantFromValue(*msgIter);
-                ++msgIter;
-            }
+            msgList = Core::requestMsgs(user, bufferId, -1, last, additional);
+            backlog << msgList;
         }
     }
 
@@ -78,18 +75,155 @@ QVariantList CoreBacklogManager::requestBacklog(BufferId bufferId, MsgId first,
 }
 
 
-QVariantList CoreBacklogManager::requestBacklogFiltered(BufferId bufferId, MsgId first, MsgId last, int limit, int additional, int type, int flags)
+//! Posted to the CoreBacklogManager once a buffer's backlog has been fetched by a BacklogQuery
+class BacklogFetchedEvent : public QEvent
+{
+public:
+    static const int EventId;
+
+    BacklogFetchedEvent(int peerId, BufferId bufferId, MsgId first, int limit, int additional, const MessageList &messages)
+        : QEvent(QEvent::Type(EventId)), peerId(peerId), bufferId(bufferId), first(first), limit(limit),
+        additional(additional), messages(messages) {}
+
+    int peerId;
+    BufferId bufferId;
+    MsgId first;
+    int limit;
+    int additional;
+    MessageList messages;
+};
+
+const int BacklogFetchedEvent::EventId = QEvent::registerEventType();
+
+
+//! Fetches the backlog of one buffer of a requestBacklogMulti() call in a backlog thread
+class BacklogQuery : public QRunnable
+{
+public:
+    BacklogQuery(std::shared_ptr<BacklogResultReceiver> resultReceiver, UserId user, int peerId, BufferId bufferId,
+                 MsgId first, int limit, int additional)
+        : _resultReceiver(std::move(resultReceiver)), _user(user), _peerId(peerId), _bufferId(bufferId),
+        _first(first), _limit(limit), _additional(additional) {}
+
+    void run() override
+    {
+        MessageList messages = fetchBacklog(_user, _bufferId, _first, -1, _limit, _additional);
+
+        QMutexLocker locker(&_resultReceiver->mutex);
+        if (_resultReceiver->receiver) {
+            QCoreApplication::postEvent(_resultReceiver->receiver,
+                                        new BacklogFetchedEvent(_peerId, _bufferId, _first, _limit, _additional, messages));
+        }
+    }
+
+private:
+    std::shared_ptr<BacklogResultReceiver> _resultReceiver;
+    UserId _user;
+    int _peerId;
+    BufferId _bufferId;
+    MsgId _first;
+    int _limit;
+    int _additional;
+};
+
+}
+
+INIT_SYNCABLE_OBJECT(CoreBacklogManager)
+CoreBacklogManager::CoreBacklogManager(CoreSession *coreSession)
+    : BacklogManager(coreSession),
+    _coreSession(coreSession),
+    _resultReceiver(new BacklogResultReceiver)
+{
+    _resultReceiver->receiver = this;
+}
+
+
+CoreBacklogManager::~CoreBacklogManager()
+{
+    // Queries still running must not post their results to us anymore
+    QMutexLocker locker(&_resultReceiver->mutex);
+    _resultReceiver->receiver = nullptr;
+}
+
+
+QVariantList CoreBacklogManager::toVariantList(const MessageList &messages) const
 {
+    return toVariantList(messages, SignalProxy::current() ? SignalProxy::current()->sourcePeer() : nullptr);
+}
+
+
+QVariantList CoreBacklogManager::toVariantList(const MessageList &messages, Peer *peer) const
+{
+    // Peers that support it get the whole backlog as one columnar block rather than a QVariant per message.
+    // There is no point in encoding for the internal peer though, which doesn't serialize anything.
+    if (peer && peer->protocol() != Protocol::InternalProtocol && peer->hasFeature(Quassel::Feature::BacklogColumnar))
+        return QVariantList() << MessageBlock::encode(messages);
+
     QVariantList backlog;
+    backlog.reserve(messages.size());
+    for (const Message &msg : messages)
+        backlog << qVariantFromValue(msg);
+    return backlog;
+}
+
+
+QVariantList CoreBacklogManager::requestBacklog(BufferId bufferId, MsgId first, MsgId last, int limit, int additional)
+{
+    return toVariantList(fetchBacklog(coreSession()->user(), bufferId, first, last, limit, additional));
+}
+
+
+void CoreBacklogManager::requestBacklogMulti(const QVariantList &requests, int additional)
+{
+    Peer *peer = coreSession()->signalProxy()->sourcePeer();
+    if (!peer)
+        return;
+
+    // Buffers are fetched concurrently, and each is sent as soon as it's ready
+    foreach(const QVariant &request, requests) {
+        QVariantList fields = request.toList();
+        if (fields.count() < 3) {
+            qWarning() << Q_FUNC_INFO << "Received invalid backlog request:" << request;
+            continue;
+        }
+        Core::runBacklogQuery(new BacklogQuery(_resultReceiver, coreSession()->user(), peer->id(), fields[0].value<BufferId>(),
+                                               fields[1].value<MsgId>(), fields[2].toInt(), additional));
+    }
+}
+
+
+void CoreBacklogManager::customEvent(QEvent *event)
+{
+    if (event->type() != BacklogFetchedEvent::EventId) {
+        BacklogManager::customEvent(event);
+        return;
+    }
+
+    auto fetched = static_cast<BacklogFetchedEvent *>(event);
+    SignalProxy *proxy = coreSession()->signalProxy();
+    Peer *peer = proxy->peerById(fetched->peerId);
+    if (!peer)
+        return; // the client is gone already
+
+    BufferId bufferId = fetched->bufferId;
+    MsgId first = fetched->first;
+    MsgId last = -1;
+    int limit = fetched->limit;
+    int additional = fetched->additional;
+    QVariantList messages = toVariantList(fetched->messages, peer);
+    proxy->restrictTargetPeers(peer, [&] {
+        SYNC_OTHER(receiveBacklog, ARG(bufferId), ARG(first), ARG(last), ARG(limit), ARG(additional), ARG(messages))
+    });
+}
+
+
+QVariantList CoreBacklogManager::requestBacklogFiltered(BufferId bufferId, MsgId first, MsgId last, int limit, int additional, int type, int flags)
+{
+    MessageList backlog;
     QList<Message> msgList;
     msgList = Core::requestMsgsFiltered(coreSession()->user(), bufferId, first, last, limit, Message::Types{type}, Message::Flags{flags});
 
-    QList<Message>::const_iterator msgIter = msgList.constBegin();
-    QList<Message>::const_iterator msgListEnd = msgList.constEnd();
-    while (msgIter != msgListEnd) {
-        backlog << qVariantFromValue(*msgIter);
-        ++msgIter;
-    }
+    backlog << msgList;
 
     if (additional && limit != 0) {
         MsgId oldestMessage = first;
@@ -111,31 +245,21 @@ QVariantList CoreBacklogManager::requestBacklogFiltered(BufferId bufferId, MsgId
         // that is, if the list of messages is not truncated by the limit
         if (last == oldestMessage) {
             msgList = Core::requestMsgsFiltered(coreSession()->user(), bufferId, -1, last, additional, Message::Types{type}, Message::Flags{flags});
-            msgIter = msgList.constBegin();
-            msgListEnd = msgList.constEnd();
-            while (msgIter != msgListEnd) {
-                backlog << qVariantFromValue(*msgIter);
-                ++msgIter;
-            }
+            backlog << msgList;
         }
     }
 
-    return backlog;
+    return toVariantList(backlog);
 }
 
 
 QVariantList CoreBacklogManager::requestBacklogAll(MsgId first, MsgId last, int limit, int additional)
 {
-    QVariantList backlog;
+    MessageList backlog;
     QList<Message> msgList;
     msgList = Core::requestAllMsgs(coreSession()->user(), first, last, limit);
 
-    QList<Message>::const_iterator msgIter = msgList.constBegin();
-    QList<Message>::const_iterator msgListEnd = msgList.constEnd();
-    while (msgIter != msgListEnd) {
-        backlog << qVariantFromValue(*msgIter);
-        ++msgIter;
-    }
+    backlog << msgList;
 
     if (additional) {
         if (first != -1) {
@@ -151,31 +275,21 @@ QVariantList CoreBacklogManager::requestBacklogAll(MsgId first, MsgId last, int
             }
         }
         msgList = Core::requestAllMsgs(coreSession()->user(), -1, last, additional);
-        msgIter = msgList.constBegin();
-        msgListEnd = msgList.constEnd();
-        while (msgIter != msgListEnd) {
-            backlog << qVariantFromValue(*msgIter);
-            ++msgIter;
-        }
+        backlog << msgList;
     }
 
-    return backlog;
+    return toVariantList(backlog);
 }
 
 
 QVariantList CoreBacklogManager::requestBacklogAllFiltered(MsgId first, MsgId last, int limit, int additional, int type,
                                                            int flags)
 {
-    QVariantList backlog;
+    MessageList backlog;
     QList<Message> msgList;
     msgList = Core::requestAllMsgsFiltered(coreSession()->user(), first, last, limit, Message::Types{type}, Message::Flags{flags});
 
-    QList<Message>::const_iterator msgIter = msgList.constBegin();
-    QList<Message>::const_iterator msgListEnd = msgList.constEnd();
-    while (msgIter != msgListEnd) {
-        backlog << qVariantFromValue(*msgIter);
-        ++msgIter;
-    }
+    backlog << msgList;
 
     if (additional) {
         if (first != -1) {
@@ -191,13 +305,17 @@ QVariantList CoreBacklogManager::requestBacklogAllFiltered(MsgId first, MsgId la
             }
         }
         msgList = Core::requestAllMsgsFiltered(coreSession()->user(), -1, last, additional, Message::Types{type}, Message::Flags{flags});
-        msgIter = msgList.constBegin();
-        msgListEnd = msgList.constEnd();
-        while (msgIter != msgListEnd) {
-            backlog << qVariantFromValue(*msgIter);
-            ++msgIter;
-        }
+        backlog << msgList;
     }
 
-    return backlog;
+    return toVariantList(backlog);
+}
+
+
+QVariantList CoreBacklogManager::requestSearchBacklog(BufferId bufferId, const QString &query, MsgId last, int limit)
+{
+    QVariantList msgIds;
+    foreach(MsgId msgId, Core::searchMsgs(coreSession()->user(), bufferId, query, last, limit))
+        msgIds << qVariantFromValue(msgId);
+    return msgIds;
 }
@@ -21,9 +21,14 @@
 #ifndef COREBACKLOGMANAGER_H
 #define COREBACKLOGMANAGER_H
 
+#include <memory>
+
 #include "backlogmanager.h"
+#include "message.h"
 
 class CoreSession;
+class Peer;
+struct BacklogResultReceiver;
 
 class CoreBacklogManager : public BacklogManager
 {
@@ -32,6 +37,7 @@ class CoreBacklogManager : public BacklogManager
 
 public:
     CoreBacklogManager(CoreSession *coreSession = 0);
+    ~CoreBacklogManager() override;
 
     CoreSession *coreSession() { return _coreSession; }
 
@@ -42,9 +48,19 @@ public slots:
     QVariantList requestBacklogAll(MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0) override;
     QVariantList requestBacklogAllFiltered(MsgId first = -1, MsgId last = -1, int limit = -1, int additional = 0,
                                            int type = -1, int flags = -1) override;
+    void requestBacklogMulti(const QVariantList &requests, int additional = 0) override;
+    QVariantList requestSearchBacklog(BufferId bufferId, const QString &query, MsgId last = -1, int limit = -1) override;
+
+protected:
+    void customEvent(QEvent *event) override;
 
 private:
+    //! Wraps the messages for the reply, using a MessageBlock if the requesting peer supports it
+    QVariantList toVariantList(const MessageList &messages) const;
+    QVariantList toVariantList(const MessageList &messages, Peer *peer) const;
+
     CoreSession *_coreSession;
+    std::shared_ptr<BacklogResultReceiver> _resultReceiver;  ///< Shared with running backlog queries
 };
 
 
@@ -34,7 +34,13 @@ public:
 
 INIT_SYNCABLE_OBJECT(CoreBufferSyncer)
 CoreBufferSyncer::CoreBufferSyncer(CoreSession *parent)
-    : BufferSyncer(Core::bufferLastSeenMsgIds(parent->user()), Core::bufferMarkerLineMsgIds(parent->user()), Core::bufferActivities(parent->user()), Core::highlightCounts(parent->user()), parent),
+    : CoreBufferSyncer(parent, Core::bufferStates(parent->user()))
+{
+}
+
+
+CoreBufferSyncer::CoreBufferSyncer(CoreSession *parent, const Storage::BufferStates &states)
+    : BufferSyncer(states.lastSeenMsgIds, states.markerLineMsgIds, states.activities, states.highlightCounts, parent),
     _coreSession(parent),
     _purgeBuffers(false)
 {
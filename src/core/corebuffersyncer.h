@@ -22,6 +22,7 @@
 #define COREBUFFERSYNCER_H
 
 #include "buffersyncer.h"
+#include "storage.h"
 
 class CoreSession;
 
@@ -79,6 +80,8 @@ protected:
     void customEvent(QEvent *event) override;
 
 private:
+    CoreBufferSyncer(CoreSession *parent, const Storage::BufferStates &states);
+
     CoreSession *_coreSession;
     bool _purgeBuffers;
 
@@ -254,6 +254,9 @@ void CoreNetwork::connectToIrc(bool reconnecting)
 
     enablePingTimeout();
 
+    // Don't let a partial line from a previous connection end up in front of the new server's data
+    _socketReadBuffer.clear();
+
     // Reset tracking for valid timestamps in PONG replies
     setPongTimestampValid(false);
 
@@ -527,16 +530,25 @@ void CoreNetwork::setMyNick(const QString &mynick)
 
 void CoreNetwork::socketHasData()
 {
-    while (socket.canReadLine()) {
-        QByteArray s = socket.readLine();
-        if (s.endsWith("\r\n"))
-            s.chop(2);
-        else if (s.endsWith("\n"))
-            s.chop(1);
-        NetworkDataEvent *event = new NetworkDataEvent(EventManager::NetworkIncoming, this, s);
-        event->setTimestamp(QDateTime::currentDateTimeUtc());
-        emit newEvent(event);
+    // Hand all complete lines to the parser as a single event instead of allocating and dispatching
+    // one event per line. A trailing partial line stays buffered until the rest of it arrives.
+    _socketReadBuffer.append(socket.readAll());
+    int end = _socketReadBuffer.lastIndexOf('\n');
+    if (end < 0)
+        return;
+
+    QByteArray lines;
+    if (end == _socketReadBuffer.length() - 1) {
+        lines.swap(_socketReadBuffer);
     }
+    else {
+        lines = _socketReadBuffer.left(end + 1);
+        _socketReadBuffer.remove(0, end + 1);
+    }
+
+    NetworkDataEvent *event = new NetworkDataEvent(EventManager::NetworkIncoming, this, lines);
+    event->setTimestamp(QDateTime::currentDateTimeUtc());
+    emit newEvent(event);
 }
 
 
@@ -513,6 +513,7 @@ private:
     QTcpSocket socket;
 #endif
     qint64 _socketId{0};
+    QByteArray _socketReadBuffer; ///< Received data not yet terminated by a line break
 
     CoreUserInputHandler *_userInputHandler;
 
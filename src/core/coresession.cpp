@@ -48,6 +48,7 @@
 #include "messageevent.h"
 #include "remotepeer.h"
 #include "storage.h"
+#include "storagewriter.h"
 #include "util.h"
 
 
@@ -154,6 +155,13 @@ CoreSession::CoreSession(UserId uid, bool restoreState, bool strictIdentEnabled,
 }
 
 
+CoreSession::~CoreSession()
+{
+    // make sure the storage writer won't post any more events to us
+    Core::flushStoredMessages(this);
+}
+
+
 void CoreSession::shutdown()
 {
     saveSessionState();
@@ -368,6 +376,18 @@ QList<BufferInfo> CoreSession::buffers() const
 
 void CoreSession::customEvent(QEvent *event)
 {
+    if (event->type() == MessagesStoredEvent::EventId) {
+        MessagesStoredEvent *storedEvent = static_cast<MessagesStoredEvent *>(event);
+        if (storedEvent->success) {
+            // FIXME: extend protocol to a displayMessages(MessageList)
+            for (int i = 0; i < storedEvent->messages.count(); i++) {
+                emit displayMsg(storedEvent->messages[i]);
+            }
+        }
+        event->accept();
+        return;
+    }
+
     if (event->type() != QEvent::User)
         return;
 
@@ -389,8 +409,10 @@ void CoreSession::processMessages()
         Message msg(bufferInfo, rawMsg.type, rawMsg.text, rawMsg.sender, senderPrefixes(rawMsg.sender, bufferInfo),
                     realName(rawMsg.sender, rawMsg.networkId),  avatarUrl(rawMsg.sender, rawMsg.networkId),
                     rawMsg.flags);
-        if(Core::storeMessage(msg))
-            emit displayMsg(msg);
+        MessageList messages;
+        messages << msg;
+        // displayMsg() is emitted once the storage writer has assigned the MsgIds
+        Core::storeMessagesAsync(messages, this);
     }
     else {
         QHash<NetworkId, QHash<QString, BufferInfo> > bufferInfoCache;
@@ -436,12 +458,7 @@ void CoreSession::processMessages()
             messages << msg;
         }
 
-        if(Core::storeMessages(messages)) {
-            // FIXME: extend protocol to a displayMessages(MessageList)
-            for (int i = 0; i < messages.count(); i++) {
-                emit displayMsg(messages[i]);
-            }
-        }
+        Core::storeMessagesAsync(messages, this);
     }
     _processMessages = false;
     _messageQueue.clear();
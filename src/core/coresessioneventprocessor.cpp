@@ -45,6 +45,7 @@ CoreSessionEventProcessor::CoreSessionEventProcessor(CoreSession *session)
     _coreSession(session)
 {
     connect(coreSession(), SIGNAL(networkDisconnected(NetworkId)), this, SLOT(destroyNetsplits(NetworkId)));
+    connect(coreSession(), SIGNAL(networkDisconnected(NetworkId)), this, SLOT(clearNamesReplies(NetworkId)));
     connect(this, SIGNAL(newEvent(Event *)), coreSession()->eventManager(), SLOT(postEvent(Event *)));
 }
 
@@ -1173,43 +1174,72 @@ void CoreSessionEventProcessor::processIrcEvent353(IrcEvent *e)
         return;
     }
 
-    QStringList nicks;
-    QStringList modes;
+    // Collect the nicks until RPL_ENDOFNAMES, so large channels spanning many replies get joined
+    // (and synced to clients) in one go
+    NamesReply &reply = _namesReplies[e->network()][e->network()->ircLower(channelname)];
 
     // Cache result of multi-prefix to avoid unneeded casts and lookups with each iteration.
     bool _useCapMultiPrefix = coreNetwork(e)->capEnabled(IrcCap::MULTI_PREFIX);
+    const QString prefixes = e->network()->prefixes();
 
-    foreach(QString nick, e->params()[2].split(' ', QString::SkipEmptyParts)) {
-        QString mode;
+    const QString names = e->params()[2];
+    const int length = names.length();
+    int pos = 0;
+    while (pos < length) {
+        int end = names.indexOf(' ', pos);
+        if (end == -1)
+            end = length;
 
+        int nickStart = pos;
         if (_useCapMultiPrefix) {
             // If multi-prefix is enabled, all modes will be sent in NAMES replies.
             // :hades.arpa 353 guest = #tethys :~&@%+aji &@Attila @+alyx +KindOne Argure
             // See: http://ircv3.net/specs/extensions/multi-prefix-3.1.html
-            while (e->network()->prefixes().contains(nick[0])) {
-                // Mode found in 1 left-most character, add it to the list.
-                // Note: sending multiple modes may cause a warning in older clients.
-                // In testing, the clients still seemed to function fine.
-                mode.append(e->network()->prefixToMode(nick[0]));
-                // Remove this mode from the nick
-                nick = nick.remove(0, 1);
-            }
-        } else if (e->network()->prefixes().contains(nick[0])) {
+            // Note: sending multiple modes may cause a warning in older clients.
+            // In testing, the clients still seemed to function fine.
+            while (nickStart < end && prefixes.contains(names.at(nickStart)))
+                nickStart++;
+        } else if (nickStart < end && prefixes.contains(names.at(nickStart))) {
             // Multi-prefix is disabled and a mode prefix was found.
-            mode = e->network()->prefixToMode(nick[0]);
-            nick = nick.mid(1);
+            nickStart++;
         }
 
         // If userhost-in-names capability is enabled, the following will be
         // in the form "nick!user@host" rather than "nick".  This works without
         // special handling as the following use nickFromHost() as needed.
         // See: http://ircv3.net/specs/extensions/userhost-in-names-3.2.html
+        if (nickStart < end) {
+            reply.nicks << names.mid(nickStart, end - nickStart);
+            reply.modes << e->network()->prefixesToModes(names.mid(pos, nickStart - pos));
+        }
 
-        nicks << nick;
-        modes << mode;
+        pos = end + 1;
     }
+}
+
+
+void CoreSessionEventProcessor::processIrcEvent366(IrcEvent *e)
+{
+    if (!checkParamCount(e, 1))
+        return;
+
+    QString channelname = e->params()[0];
+
+    auto netReplies = _namesReplies.find(e->network());
+    if (netReplies == _namesReplies.end())
+        return;
+    NamesReply reply = netReplies->take(e->network()->ircLower(channelname));
+    if (netReplies->isEmpty())
+        _namesReplies.erase(netReplies);
+
+    if (reply.nicks.isEmpty())
+        return;
+
+    IrcChannel *channel = e->network()->ircChannel(channelname);
+    if (!channel)
+        return;
 
-    channel->joinIrcUsers(nicks, modes);
+    channel->joinIrcUsers(reply.nicks, reply.modes);
 }
 
 
@@ -1499,6 +1529,16 @@ void CoreSessionEventProcessor::destroyNetsplits(NetworkId netId)
 }
 
 
+void CoreSessionEventProcessor::clearNamesReplies(NetworkId netId)
+{
+    Network *net = coreSession()->network(netId);
+    if (!net)
+        return;
+
+    _namesReplies.remove(net);
+}
+
+
 /*******************************/
 /******** CTCP HANDLING ********/
 /*******************************/
@@ -94,6 +94,7 @@ public:
     Q_INVOKABLE void processIrcEvent352(IrcEvent *event);          // RPL_WHOREPLY
     Q_INVOKABLE void processIrcEvent353(IrcEvent *event);          // RPL_NAMREPLY
     Q_INVOKABLE void processIrcEvent354(IrcEvent *event);          // RPL_WHOSPCRPL
+    Q_INVOKABLE void processIrcEvent366(IrcEvent *event);          // RPL_ENDOFNAMES
     Q_INVOKABLE void processIrcEvent403(IrcEventNumeric *event);   // ERR_NOSUCHCHANNEL
     Q_INVOKABLE void processIrcEvent432(IrcEventNumeric *event);   // ERR_ERRONEUSNICKNAME
     Q_INVOKABLE void processIrcEvent433(IrcEventNumeric *event);   // ERR_NICKNAMEINUSE
@@ -154,6 +155,9 @@ private slots:
       */
     void destroyNetsplits(NetworkId network);
 
+    //! Drop NAMES replies still waiting for their RPL_ENDOFNAMES
+    void clearNamesReplies(NetworkId network);
+
 private:
     CoreSession *_coreSession;
 
@@ -162,6 +166,15 @@ private:
     // value: the corresponding netsplit object
     QHash<Network *, QHash<QString, Netsplit *> > _netsplits;
 
+    //! Nicks and modes from RPL_NAMREPLY, collected until RPL_ENDOFNAMES
+    struct NamesReply {
+        QStringList nicks;
+        QStringList modes;
+    };
+
+    // key: channel name folded with Network::ircLower()
+    QHash<Network *, QHash<QString, NamesReply> > _namesReplies;
+
     /**
      * Process given WHO reply information, updating user data, channel modes, etc as needed
      *
@@ -33,6 +33,72 @@
 #  include "keyevent.h"
 #endif
 
+namespace {
+
+inline bool isIrcWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+
+//! Returns the value of a numeric reply code, or 0 if the command isn't numeric
+uint numericCommand(const char *cmd, int length)
+{
+    if (length > 9)
+        return 0;
+    uint num = 0;
+    for (int i = 0; i < length; ++i) {
+        if (cmd[i] < '0' || cmd[i] > '9')
+            return 0;
+        num = num * 10 + (cmd[i] - '0');
+    }
+    return num;
+}
+
+
+//! Maps an upper-case IRC command (e.g. "PRIVMSG") to its IrcEvent type
+/**
+ * The table is built once from the EventType enum, so incoming lines don't have to assemble
+ * "IrcEvent" + command strings and resolve them through the meta object anymore.
+ */
+const QHash<QByteArray, EventManager::EventType> &commandEventTypes()
+{
+    static const QHash<QByteArray, EventManager::EventType> types = []() {
+        QHash<QByteArray, EventManager::EventType> result;
+        const QString typePrefix = QLatin1String("IrcEvent");
+        for (int t = EventManager::IrcEvent + 1; t < EventManager::IrcEventNumeric; ++t) {
+            // Internal types that don't correspond to a command sent by the server
+            if (t == EventManager::IrcEventRawPrivmsg || t == EventManager::IrcEventRawNotice || t == EventManager::IrcEventUnknown)
+                continue;
+            QString name = EventManager::enumName(t);
+            if (name.isEmpty())
+                break; // end of the consecutive IrcEvent values
+            if (name.startsWith(typePrefix))
+                result.insert(name.mid(typePrefix.length()).toUpper().toLatin1(), static_cast<EventManager::EventType>(t));
+        }
+        return result;
+    }();
+    return types;
+}
+
+
+//! Returns the event type for a non-numeric command, or IrcEventUnknown
+EventManager::EventType commandEventType(const char *cmd, int length)
+{
+    // Commands are case insensitive. Upper-case into a stack buffer so the lookup doesn't need to
+    // allocate; anything longer than that is not a command we know about anyway.
+    char upper[32];
+    if (length > static_cast<int>(sizeof(upper)))
+        return EventManager::IrcEventUnknown;
+    for (int i = 0; i < length; ++i)
+        upper[i] = (cmd[i] >= 'a' && cmd[i] <= 'z') ? cmd[i] - 'a' + 'A' : cmd[i];
+
+    return commandEventTypes().value(QByteArray::fromRawData(upper, length), EventManager::IrcEventUnknown);
+}
+
+}
+
+
 IrcParser::IrcParser(CoreSession *session) :
     QObject(session),
     _coreSession(session)
@@ -91,7 +157,26 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
     // note that the IRC server is still alive
     net->resetPingTimeout();
 
-    QByteArray msg = e->data();
+    // The event carries every complete line that was read from the socket in one go, sharing one
+    // timestamp. Walk them in place; each line is only a view into the event's buffer.
+    const QByteArray data = e->data();
+    const QDateTime timestamp = e->timestamp();
+    int start = 0;
+    while (start < data.length()) {
+        int end = data.indexOf('\n', start);
+        if (end < 0)
+            end = data.length();
+        int lineLength = end - start;
+        if (lineLength > 0 && data.at(start + lineLength - 1) == '\r')
+            --lineLength;
+        processNetworkLine(net, QByteArray::fromRawData(data.constData() + start, lineLength), timestamp);
+        start = end + 1;
+    }
+}
+
+
+void IrcParser::processNetworkLine(CoreNetwork *net, const QByteArray &msg, const QDateTime &timestamp)
+{
     if (msg.isEmpty()) {
         qWarning() << "Received empty string from server!";
         return;
@@ -104,59 +189,74 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
         qDebug() << "IRC net" << net->networkId() << "<<" << msg;
     }
 
-    // Now we split the raw message into its various parts...
+    // Now we split the raw message into its various parts. We walk the raw buffer once and only copy
+    // out the pieces the events need, instead of splitting the whole line into a temporary list first.
+    // Multiple spaces in a row (as sent by some faulty ircds) are treated as a single separator.
+    const char *data = msg.constData();
+    const int length = msg.length();
+    int pos = 0;
+
+    auto skipSpaces = [&]() {
+        while (pos < length && data[pos] == ' ')
+            ++pos;
+    };
+    auto tokenEnd = [&]() {
+        int end = pos;
+        while (end < length && data[end] != ' ')
+            ++end;
+        return end;
+    };
+
     QString prefix;
-    QByteArray trailing;
     QString cmd, target;
 
-    // First, check for a trailing parameter introduced by " :", since this might screw up splitting the msg
-    // NOTE: This assumes that this is true in raw encoding, but well, hopefully there are no servers running in japanese on protocol level...
-    int idx = msg.indexOf(" :");
-    if (idx >= 0) {
-        if (msg.length() > idx + 2)
-            trailing = msg.mid(idx + 2);
-        msg = msg.left(idx);
-    }
-    // OK, now it is safe to split...
-    QList<QByteArray> params = msg.split(' ');
-
-    // This could still contain empty elements due to (faulty?) ircds sending multiple spaces in a row
-    // Also, QByteArray is not nearly as convenient to work with as QString for such things :)
-    QList<QByteArray>::iterator iter = params.begin();
-    while (iter != params.end()) {
-        if (iter->isEmpty())
-            iter = params.erase(iter);
-        else
-            ++iter;
+    skipSpaces();
+    // a colon as the first char indicates the existence of a prefix
+    if (pos < length && data[pos] == ':') {
+        int end = tokenEnd();
+        prefix = net->serverDecode(QByteArray::fromRawData(data + pos + 1, end - pos - 1));
+        pos = end;
+        skipSpaces();
     }
 
-    if (!trailing.isEmpty())
-        params << trailing;
-    if (params.count() < 1) {
+    // next string without a whitespace is the command
+    int cmdPos = pos;
+    pos = tokenEnd();
+    int cmdLength = pos - cmdPos;
+    while (cmdLength > 0 && isIrcWhitespace(data[cmdPos])) {
+        ++cmdPos;
+        --cmdLength;
+    }
+    while (cmdLength > 0 && isIrcWhitespace(data[cmdPos + cmdLength - 1]))
+        --cmdLength;
+    if (cmdLength == 0) {
         qWarning() << "Received invalid string from server!";
         return;
     }
+    cmd = QString::fromLatin1(data + cmdPos, cmdLength);
 
-    QString foo = net->serverDecode(params.takeFirst());
-
-    // a colon as the first chars indicates the existence of a prefix
-    if (foo[0] == ':') {
-        foo.remove(0, 1);
-        prefix = foo;
-        if (params.count() < 1) {
-            qWarning() << "Received invalid string from server!";
-            return;
+    // The remaining tokens are the params. A param starting with a colon is the trailing one, which
+    // extends to the end of the line and may contain spaces.
+    // NOTE: This assumes that this is true in raw encoding, but well, hopefully there are no servers running in japanese on protocol level...
+    QList<QByteArray> params;
+    forever {
+        skipSpaces();
+        if (pos >= length)
+            break;
+        if (data[pos] == ':') {
+            if (pos + 1 < length)
+                params << msg.mid(pos + 1);
+            break;
         }
-        foo = net->serverDecode(params.takeFirst());
+        int end = tokenEnd();
+        params << msg.mid(pos, end - pos);
+        pos = end;
     }
 
-    // next string without a whitespace is the command
-    cmd = foo.trimmed();
-
     QList<Event *> events;
     EventManager::EventType type = EventManager::Invalid;
 
-    uint num = cmd.toUInt();
+    uint num = numericCommand(data + cmdPos, cmdLength);
     if (num > 0) {
         // numeric reply
         if (params.count() == 0) {
@@ -169,12 +269,7 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
     }
     else {
         // any other irc command
-        QString typeName = QLatin1String("IrcEvent") + cmd.at(0).toUpper() + cmd.mid(1).toLower();
-        type = eventManager()->eventTypeByName(typeName);
-        if (type == EventManager::Invalid) {
-            type = eventManager()->eventTypeByName("IrcEventUnknown");
-            Q_ASSERT(type != EventManager::Invalid);
-        }
+        type = commandEventType(data + cmdPos, cmdLength);
         target = QString();
     }
 
@@ -211,7 +306,7 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
                 // consider including this within an if (!isSelfMessage) block
                 msg = decrypt(net, target, msg);
 
-                IrcEventRawMessage *rawMessage = new IrcEventRawMessage(EventManager::IrcEventRawPrivmsg, net, msg, prefix, target, e->timestamp());
+                IrcEventRawMessage *rawMessage = new IrcEventRawMessage(EventManager::IrcEventRawPrivmsg, net, msg, prefix, target, timestamp);
                 if (isSelfMessage) {
                     // Self-messages need processed differently, tag as such via flag.
                     rawMessage->setFlag(EventManager::Self);
@@ -246,7 +341,7 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
                         CoreIrcChannel *chan = static_cast<CoreIrcChannel *>(net->ircChannel(channelname)); // we only have CoreIrcChannels in the core, so this cast is safe
                         if (chan && !chan->receivedWelcomeMsg()) {
                             chan->setReceivedWelcomeMsg();
-                            events << new MessageEvent(Message::Notice, net, decMsg, prefix, channelname, Message::None, e->timestamp());
+                            events << new MessageEvent(Message::Notice, net, decMsg, prefix, channelname, Message::None, timestamp);
                             continue;
                         }
                     }
@@ -279,7 +374,7 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
                 } else
 #endif
                 {
-                    IrcEventRawMessage *rawMessage = new IrcEventRawMessage(EventManager::IrcEventRawNotice, net, params[1], prefix, target, e->timestamp());
+                    IrcEventRawMessage *rawMessage = new IrcEventRawMessage(EventManager::IrcEventRawNotice, net, params[1], prefix, target, timestamp);
                     if (isSelfMessage) {
                         // Self-messages need processed differently, tag as such via flag.
                         rawMessage->setFlag(EventManager::Self);
@@ -365,9 +460,9 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
                 // If server doesn't support capabilities, it will report this message.  Turn it
                 // into a nicer message since it's not a real error.
                 defaultHandling = false;
-                events << new MessageEvent(Message::Server, e->network(),
+                events << new MessageEvent(Message::Server, net,
                                            tr("Capability negotiation not supported"),
-                                           QString(), QString(), Message::None, e->timestamp());
+                                           QString(), QString(), Message::None, timestamp);
             }
             break;
         }
@@ -391,7 +486,7 @@ void IrcParser::processNetworkIncoming(NetworkDataEvent *e)
         else
             event = new IrcEvent(type, net, prefix);
         event->setParams(decParams);
-        event->setTimestamp(e->timestamp());
+        event->setTimestamp(timestamp);
         events << event;
     }
 
@@ -23,6 +23,7 @@
 
 #include "coresession.h"
 
+class CoreNetwork;
 class Event;
 class EventManager;
 class IrcEvent;
@@ -44,6 +45,13 @@ signals:
 protected:
     Q_INVOKABLE void processNetworkIncoming(NetworkDataEvent *e);
 
+    //! Parses a single raw line from the server and emits the resulting events
+    /**
+      @param msg The line without its line break. It may point into the buffer of the NetworkDataEvent
+                 being processed, so anything kept beyond this call must be copied out of it.
+     */
+    void processNetworkLine(CoreNetwork *net, const QByteArray &msg, const QDateTime &timestamp);
+
     bool checkParamCount(const QString &cmd, const QList<QByteArray> &params, int minParams);
 
     // no-op if we don't have crypto support!
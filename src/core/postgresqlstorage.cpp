@@ -20,6 +20,8 @@
 
 #include "postgresqlstorage.h"
 
+#include <limits>
+
 #include <QtSql>
 
 #include "logmessage.h"
@@ -97,6 +99,9 @@ QVariantList PostgreSqlStorage::setupData() const
 
 bool PostgreSqlStorage::initDbSession(QSqlDatabase &db)
 {
+    // this is a fresh connection, so none of our statements are prepared on it yet
+    _preparedQueries.localData().clear();
+
     // check whether the Qt driver performs string escaping or not.
     // i.e. test if it doubles slashes.
     QSqlField testField;
@@ -346,6 +351,7 @@ void PostgreSqlStorage::delUser(UserId user)
     }
     else {
         db.commit();
+        senderIdCache().clear();
         emit userRemoved(user);
     }
 }
@@ -1595,6 +1601,39 @@ int PostgreSqlStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
     return result;
 }
 
+
+Storage::BufferStates PostgreSqlStorage::bufferStates(UserId user)
+{
+    BufferStates states;
+
+    QSqlDatabase db = logDb();
+    if (!beginReadOnlyTransaction(db)) {
+        qWarning() << "PostgreSqlStorage::bufferStates(): cannot start read only transaction!";
+        qWarning() << " -" << qPrintable(db.lastError().text());
+        return states;
+    }
+
+    QSqlQuery query(db);
+    query.prepare(queryString("select_buffer_states"));
+    query.bindValue(":userid", user.toInt());
+    safeExec(query);
+    if (!watchQuery(query)) {
+        db.rollback();
+        return states;
+    }
+
+    while (query.next()) {
+        BufferId bufferId = query.value(0).toInt();
+        states.lastSeenMsgIds[bufferId] = query.value(1).toLongLong();
+        states.markerLineMsgIds[bufferId] = query.value(2).toLongLong();
+        states.activities[bufferId] = Message::Types(query.value(3).toInt());
+        states.highlightCounts[bufferId] = query.value(4).toInt();
+    }
+
+    db.commit();
+    return states;
+}
+
 bool PostgreSqlStorage::logMessage(Message &msg)
 {
     QSqlDatabase db = logDb();
@@ -1604,33 +1643,11 @@ bool PostgreSqlStorage::logMessage(Message &msg)
         return false;
     }
 
-    QVariantList senderParams;
-    senderParams << msg.sender()
-                 << msg.realName()
-                 << msg.avatarUrl();
-    QSqlQuery getSenderIdQuery = executePreparedQuery("select_senderid", senderParams, db);
-    qint64 senderId;
-    if (getSenderIdQuery.first()) {
-        senderId = getSenderIdQuery.value(0).toLongLong();
-    }
-    else {
-        // it's possible that the sender was already added by another thread
-        // since the insert might fail we're setting a savepoint
-        savePoint("sender_sp1", db);
-        QSqlQuery addSenderQuery = executePreparedQuery("insert_sender", senderParams, db);
-
-        if (addSenderQuery.lastError().isValid()) {
-            rollbackSavePoint("sender_sp1", db);
-            getSenderIdQuery = executePreparedQuery("select_senderid", senderParams, db);
-            watchQuery(getSenderIdQuery);
-            getSenderIdQuery.first();
-            senderId = getSenderIdQuery.value(0).toLongLong();
-        }
-        else {
-            releaseSavePoint("sender_sp1", db);
-            addSenderQuery.first();
-            senderId = addSenderQuery.value(0).toLongLong();
-        }
+    QHash<SenderData, qint64> newSenders;
+    qint64 senderId = this->senderId(db, { msg.sender(), msg.realName(), msg.avatarUrl() }, newSenders);
+    if (senderId < 0) {
+        db.rollback();
+        return false;
     }
 
     QVariantList params;
@@ -1653,6 +1670,8 @@ bool PostgreSqlStorage::logMessage(Message &msg)
     logMessageQuery.first();
     MsgId msgId = logMessageQuery.value(0).toLongLong();
     db.commit();
+    for (auto it = newSenders.constBegin(); it != newSenders.constEnd(); ++it)
+        senderIdCache().insert(it.key(), it.value());
     if (msgId.isValid()) {
         msg.setMsgId(msgId);
         return true;
@@ -1672,47 +1691,16 @@ bool PostgreSqlStorage::logMessages(MessageList &msgs)
         return false;
     }
 
-    QList<int> senderIdList;
-    QHash<SenderData, qint64> senderIds;
-    QSqlQuery addSenderQuery;
-    QSqlQuery selectSenderQuery;;
+    QList<qint64> senderIdList;
+    QHash<SenderData, qint64> newSenders;
     for (int i = 0; i < msgs.count(); i++) {
         auto &msg = msgs.at(i);
-        SenderData sender = { msg.sender(), msg.realName(), msg.avatarUrl() };
-        if (senderIds.contains(sender)) {
-            senderIdList << senderIds[sender];
-            continue;
-        }
-
-        QVariantList senderParams;
-        senderParams << sender.sender
-                     << sender.realname
-                     << sender.avatarurl;
-
-        selectSenderQuery = executePreparedQuery("select_senderid", senderParams, db);
-        if (selectSenderQuery.first()) {
-            senderIdList << selectSenderQuery.value(0).toLongLong();
-            senderIds[sender] = selectSenderQuery.value(0).toLongLong();
-        }
-        else {
-            savePoint("sender_sp", db);
-            addSenderQuery = executePreparedQuery("insert_sender", senderParams, db);
-            if (addSenderQuery.lastError().isValid()) {
-                // seems it was inserted meanwhile... by a different thread
-                rollbackSavePoint("sender_sp", db);
-                selectSenderQuery = executePreparedQuery("select_senderid", senderParams, db);
-                watchQuery(selectSenderQuery);
-                selectSenderQuery.first();
-                senderIdList << selectSenderQuery.value(0).toLongLong();
-                senderIds[sender] = selectSenderQuery.value(0).toLongLong();
-            }
-            else {
-                releaseSavePoint("sender_sp", db);
-                addSenderQuery.first();
-                senderIdList << addSenderQuery.value(0).toLongLong();
-                senderIds[sender] = addSenderQuery.value(0).toLongLong();
-            }
+        qint64 senderId = this->senderId(db, { msg.sender(), msg.realName(), msg.avatarUrl() }, newSenders);
+        if (senderId < 0) {
+            db.rollback();
+            return false;
         }
+        senderIdList << senderId;
     }
 
     // yes we loop twice over the same list. This avoids alternating queries.
@@ -1750,10 +1738,58 @@ bool PostgreSqlStorage::logMessages(MessageList &msgs)
     }
 
     db.commit();
+    for (auto it = newSenders.constBegin(); it != newSenders.constEnd(); ++it)
+        senderIdCache().insert(it.key(), it.value());
     return true;
 }
 
 
+qint64 PostgreSqlStorage::senderId(QSqlDatabase &db, const SenderData &sender, QHash<SenderData, qint64> &newSenders)
+{
+    auto it = newSenders.constFind(sender);
+    if (it != newSenders.constEnd())
+        return it.value();
+
+    qint64 senderId = senderIdCache().senderId(sender);
+    if (senderId >= 0)
+        return senderId;
+
+    QVariantList senderParams;
+    senderParams << sender.sender
+                 << sender.realname
+                 << sender.avatarurl;
+
+    QSqlQuery selectSenderQuery = executePreparedQuery("select_senderid", senderParams, db);
+    if (selectSenderQuery.first()) {
+        // visible to us and not inserted by this transaction, so it has been committed already
+        senderId = selectSenderQuery.value(0).toLongLong();
+        senderIdCache().insert(sender, senderId);
+        return senderId;
+    }
+
+    // it's possible that the sender was already added by another thread
+    // since the insert might fail we're setting a savepoint
+    savePoint("sender_sp", db);
+    QSqlQuery addSenderQuery = executePreparedQuery("insert_sender", senderParams, db);
+    if (addSenderQuery.lastError().isValid()) {
+        rollbackSavePoint("sender_sp", db);
+        selectSenderQuery = executePreparedQuery("select_senderid", senderParams, db);
+        watchQuery(selectSenderQuery);
+        if (!selectSenderQuery.first())
+            return -1;
+        senderId = selectSenderQuery.value(0).toLongLong();
+        senderIdCache().insert(sender, senderId);
+    }
+    else {
+        releaseSavePoint("sender_sp", db);
+        addSenderQuery.first();
+        senderId = addSenderQuery.value(0).toLongLong();
+        newSenders[sender] = senderId;
+    }
+    return senderId;
+}
+
+
 QList<Message> PostgreSqlStorage::requestMsgs(UserId user, BufferId bufferId, MsgId first, MsgId last, int limit)
 {
     QList<Message> messagelist;
@@ -2009,6 +2045,47 @@ QList<Message> PostgreSqlStorage::requestAllMsgsFiltered(UserId user, MsgId firs
     return messagelist;
 }
 
+
+QList<MsgId> PostgreSqlStorage::searchMsgs(UserId user, BufferId bufferId, const QString &query, MsgId last, int limit)
+{
+    QList<MsgId> msgIds;
+
+    QSqlDatabase db = logDb();
+    if (!beginReadOnlyTransaction(db)) {
+        qWarning() << "PostgreSqlStorage::searchMsgs(): cannot start read only transaction!";
+        qWarning() << " -" << qPrintable(db.lastError().text());
+        return msgIds;
+    }
+
+    BufferInfo bufferInfo = getBufferInfo(user, bufferId);
+    if (!bufferInfo.isValid()) {
+        db.rollback();
+        return msgIds;
+    }
+
+    QVariantList params;
+    params << query;
+    params << bufferId.toInt();
+    params << (last == -1 ? std::numeric_limits<qint64>::max() : last.toQint64());
+    if (limit != -1)
+        params << limit;
+    else
+        params << QVariant(QVariant::Int);
+
+    QSqlQuery searchQuery = executePreparedQuery("select_messagesSearch", params, db);
+    if (!watchQuery(searchQuery)) {
+        db.rollback();
+        return msgIds;
+    }
+
+    while (searchQuery.next())
+        msgIds << searchQuery.value(0).toLongLong();
+
+    db.commit();
+    return msgIds;
+}
+
+
 QMap<UserId, QString> PostgreSqlStorage::getAllAuthUserNames()
 {
     QMap<UserId, QString> authusernames;
@@ -2069,60 +2146,48 @@ bool PostgreSqlStorage::beginReadOnlyTransaction(QSqlDatabase &db)
 }
 
 
+bool PostgreSqlStorage::prepareStatement(const QString &queryname, QSqlDatabase &db)
+{
+    // The statement might still exist on this connection without us knowing about it, and a failing PREPARE would
+    // abort the running transaction. This check only happens once per statement and connection, though.
+    QSqlQuery checkQuery = db.exec(QString("SELECT count(name) FROM pg_prepared_statements WHERE name = 'quassel_%1' AND from_sql = TRUE").arg(queryname.toLower()));
+    checkQuery.first();
+    if (checkQuery.value(0).toInt() == 0) {
+        db.exec(QString("PREPARE quassel_%1 AS %2").arg(queryname, queryString(queryname)));
+        if (db.lastError().isValid()) {
+            qWarning() << "PostgreSqlStorage::prepareStatement(): unable to prepare query:" << queryname << "AS" << queryString(queryname);
+            qWarning() << "  Error:" << db.lastError().text();
+            return false;
+        }
+    }
+    _preparedQueries.localData().insert(queryname);
+    return true;
+}
+
+
 QSqlQuery PostgreSqlStorage::prepareAndExecuteQuery(const QString &queryname, const QString &paramstring, QSqlDatabase &db)
 {
-    // Query preparing is done lazily. That means that instead of always checking if the query is already prepared
-    // we just EXECUTE and catch the error
-    QSqlQuery query;
+    // Statements are prepared once per connection, and we keep track of which ones are. Executing a query thus
+    // takes a single round trip, instead of wrapping every EXECUTE into a savepoint to catch unprepared statements.
+    if (!_preparedQueries.localData().contains(queryname) && !prepareStatement(queryname, db))
+        return QSqlQuery(db);
 
-    db.exec("SAVEPOINT quassel_prepare_query");
-    if (paramstring.isNull()) {
-        query = db.exec(QString("EXECUTE quassel_%1").arg(queryname));
-    }
-    else {
-        query = db.exec(QString("EXECUTE quassel_%1 (%2)").arg(queryname).arg(paramstring));
-    }
+    QString statement = paramstring.isNull() ? QString("EXECUTE quassel_%1").arg(queryname)
+                                             : QString("EXECUTE quassel_%1 (%2)").arg(queryname, paramstring);
+    QSqlQuery query = db.exec(statement);
 
-    if (!db.isOpen() || db.lastError().isValid()) {
+    if (!db.isOpen()) {
         // If the query failed because the DB connection was down, reopen the connection and start a new transaction.
-        if (!db.isOpen()) {
-            db = logDb();
-            if (!beginTransaction(db)) {
-                qWarning() << "PostgreSqlStorage::prepareAndExecuteQuery(): cannot start transaction while recovering from connection loss!";
-                qWarning() << " -" << qPrintable(db.lastError().text());
-                return query;
-            }
-            db.exec("SAVEPOINT quassel_prepare_query");
-        } else {
-            db.exec("ROLLBACK TO SAVEPOINT quassel_prepare_query");
-        }
-
-        // and once again: Qt leaves us without error codes so we either parse (language dependent(!)) strings
-        // or we just guess the error. As we're only interested in unprepared queries, this will be our guess. :)
-        QSqlQuery checkQuery = db.exec(QString("SELECT count(name) FROM pg_prepared_statements WHERE name = 'quassel_%1' AND from_sql = TRUE").arg(queryname.toLower()));
-        checkQuery.first();
-        if (checkQuery.value(0).toInt() == 0) {
-            db.exec(QString("PREPARE quassel_%1 AS %2").arg(queryname).arg(queryString(queryname)));
-            if (db.lastError().isValid()) {
-                qWarning() << "PostgreSqlStorage::prepareQuery(): unable to prepare query:" << queryname << "AS" << queryString(queryname);
-                qWarning() << "  Error:" << db.lastError().text();
-                return QSqlQuery(db);
-            }
-        }
-        // we always execute the query again, even if the query was already prepared.
-        // this ensures, that the error is properly propagated to the calling function
-        // (otherwise the last call would be the testing select to pg_prepared_statements
-        // which always gives a proper result and the error would be lost)
-        if (paramstring.isNull()) {
-            query = db.exec(QString("EXECUTE quassel_%1").arg(queryname));
-        }
-        else {
-            query = db.exec(QString("EXECUTE quassel_%1 (%2)").arg(queryname).arg(paramstring));
+        // Reconnecting resets the prepared statements (see initDbSession()), so the query needs to be prepared again.
+        db = logDb();
+        if (!beginTransaction(db)) {
+            qWarning() << "PostgreSqlStorage::prepareAndExecuteQuery(): cannot start transaction while recovering from connection loss!";
+            qWarning() << " -" << qPrintable(db.lastError().text());
+            return query;
         }
-    }
-    else {
-        // only release the SAVEPOINT
-        db.exec("RELEASE SAVEPOINT quassel_prepare_query");
+        if (!prepareStatement(queryname, db))
+            return QSqlQuery(db);
+        query = db.exec(statement);
     }
     return query;
 }
@@ -2171,6 +2236,7 @@ QSqlQuery PostgreSqlStorage::executePreparedQuery(const QString &queryname, cons
 void PostgreSqlStorage::deallocateQuery(const QString &queryname, const QSqlDatabase &db)
 {
     db.exec(QString("DEALLOCATE quassel_%1").arg(queryname));
+    _preparedQueries.localData().remove(queryname);
 }
 
 
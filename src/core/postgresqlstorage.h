@@ -22,8 +22,10 @@
 
 #include "abstractsqlstorage.h"
 
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlQuery>
+#include <QThreadStorage>
 
 class PostgreSqlStorage : public AbstractSqlStorage
 {
@@ -103,6 +105,7 @@ public slots:
     void setHighlightCount(UserId id, BufferId bufferId, int count) override;
     QHash<BufferId, int> highlightCounts(UserId id) override;
     int highlightCount(BufferId bufferId, MsgId lastSeenMsgId) override;
+    BufferStates bufferStates(UserId user) override;
     QHash<QString, QByteArray> bufferCiphers(UserId user, const NetworkId &networkId) override;
     void setBufferCipher(UserId user, const NetworkId &networkId, const QString &bufferName, const QByteArray &cipher) override;
 
@@ -117,6 +120,7 @@ public slots:
     QList<Message> requestAllMsgsFiltered(UserId user, MsgId first = -1, MsgId last = -1, int limit = -1,
                                           Message::Types type = Message::Types{-1},
                                           Message::Flags flags = Message::Flags{-1}) override;
+    QList<MsgId> searchMsgs(UserId user, BufferId bufferId, const QString &query, MsgId last = -1, int limit = -1) override;
 
     /* Sysident handling */
     QMap<UserId, QString> getAllAuthUserNames() override;
@@ -153,12 +157,22 @@ private:
     void bindServerInfo(QSqlQuery &query, const Network::Server &server);
     QSqlQuery prepareAndExecuteQuery(const QString &queryname, const QString &paramstring, QSqlDatabase &db);
     QSqlQuery prepareAndExecuteQuery(const QString &queryname, QSqlDatabase &db) { return prepareAndExecuteQuery(queryname, QString(), db); }
+    //! Prepares the named query on the given connection as quassel_<queryname>
+    bool prepareStatement(const QString &queryname, QSqlDatabase &db);
+
+    //! Returns the senderid for the given sender, creating it if necessary (-1 on error)
+    /** Must be called within a transaction. Newly inserted senders are added to newSenders and
+     *  must only be put into the sender id cache after committing.
+     */
+    qint64 senderId(QSqlDatabase &db, const SenderData &sender, QHash<SenderData, qint64> &newSenders);
 
     QString _hostName;
     int _port;
     QString _databaseName;
     QString _userName;
     QString _password;
+
+    QThreadStorage<QSet<QString>> _preparedQueries; ///< Queries prepared on this thread's connection
 };
 
 
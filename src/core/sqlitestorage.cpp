@@ -20,6 +20,8 @@
 
 #include "sqlitestorage.h"
 
+#include <limits>
+
 #include <QtSql>
 
 #include "logmessage.h"
@@ -27,6 +29,8 @@
 #include "quassel.h"
 
 int SqliteStorage::_maxRetryCount = 150;
+// SQLite limits the number of host parameters per statement to 999 by default (7 per row)
+const int SqliteStorage::_maxMessagesPerInsert = 128;
 
 SqliteStorage::SqliteStorage(QObject *parent)
     : AbstractSqlStorage(parent)
@@ -70,6 +74,30 @@ QString SqliteStorage::description() const
 }
 
 
+bool SqliteStorage::initDbSession(QSqlDatabase &db)
+{
+    // Write-ahead logging lets readers run concurrently with the (single) writer. The journal mode
+    // is persistent, but asking for it on every connection tells us whether it's actually in use
+    // (e.g. it isn't supported on some network filesystems).
+    QSqlQuery query = db.exec("PRAGMA journal_mode = WAL");
+    bool walMode = query.first() && query.value(0).toString().toLower() == "wal";
+    if (!_walMode && walMode) {
+        // the first connection is opened during init, before any other thread touches the storage
+        _walMode = true;
+    }
+    else if (_walMode && !walMode) {
+        qWarning() << "SqliteStorage: Unable to use write-ahead logging for a new connection:" << query.lastError().text();
+        return false;
+    }
+
+    if (walMode) {
+        // in WAL mode, NORMAL is still safe against corruption and avoids an fsync per commit
+        db.exec("PRAGMA synchronous = NORMAL");
+    }
+    return true;
+}
+
+
 int SqliteStorage::installedSchemaVersion()
 {
     // only used when there is a singlethread (during startup)
@@ -314,6 +342,7 @@ void SqliteStorage::delUser(UserId user)
         safeExec(query);
         // I hate the lack of foreign keys and on delete cascade... :(
         db.commit();
+        senderIdCache().clear();
     }
     unlock();
 
@@ -506,7 +535,7 @@ bool SqliteStorage::updateIdentity(UserId user, const CoreIdentity &identity)
         checkQuery.prepare(queryString("select_checkidentity"));
         checkQuery.bindValue(":identityid", identity.id().toInt());
         checkQuery.bindValue(":userid", user.toInt());
-        lockForRead();
+        lockForWrite();
         safeExec(checkQuery);
 
         // there should be exactly one identity for the given id and user
@@ -580,7 +609,7 @@ void SqliteStorage::removeIdentity(UserId user, IdentityId identityId)
         checkQuery.prepare(queryString("select_checkidentity"));
         checkQuery.bindValue(":identityid", identityId.toInt());
         checkQuery.bindValue(":userid", user.toInt());
-        lockForRead();
+        lockForWrite();
         safeExec(checkQuery);
 
         // there should be exactly one identity for the given id and user
@@ -1228,8 +1257,13 @@ BufferInfo SqliteStorage::bufferInfo(UserId user, const NetworkId &networkId, Bu
             createQuery.bindValue(":buffercname", buffer.toLower());
             createQuery.bindValue(":joined", type & BufferInfo::ChannelBuffer ? 1 : 0);
 
+            // start over with a fresh transaction once we hold the write lock, so the insert
+            // doesn't work on the (possibly outdated) snapshot of the read above
+            query.finish();
+            db.commit();
             unlock();
             lockForWrite();
+            db.transaction();
             safeExec(createQuery);
             watchQuery(createQuery);
             bufferInfo = BufferInfo(createQuery.lastInsertId().toInt(), networkId, type, 0, buffer);
@@ -1414,7 +1448,7 @@ bool SqliteStorage::mergeBuffersPermanently(const UserId &user, const BufferId &
         checkQuery.bindValue(":newbufferid", bufferId1.toInt());
         checkQuery.bindValue(":userid", user.toInt());
 
-        lockForRead();
+        lockForWrite();
         safeExec(checkQuery);
         error = (!checkQuery.first() || checkQuery.value(0).toInt() != 2);
     }
@@ -1747,118 +1781,115 @@ int SqliteStorage::highlightCount(BufferId bufferId, MsgId lastSeenMsgId)
     return result;
 }
 
-bool SqliteStorage::logMessage(Message &msg)
+
+Storage::BufferStates SqliteStorage::bufferStates(UserId user)
 {
+    BufferStates states;
+
     QSqlDatabase db = logDb();
     db.transaction();
 
     bool error = false;
     {
-        QSqlQuery logMessageQuery(db);
-        logMessageQuery.prepare(queryString("insert_message"));
-        // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
-        // seconds.  This nets us more precision as well as simplifying 64-bit time.
-        logMessageQuery.bindValue(":time", msg.timestamp().toMSecsSinceEpoch());
-        logMessageQuery.bindValue(":bufferid", msg.bufferInfo().bufferId().toInt());
-        logMessageQuery.bindValue(":type", msg.type());
-        logMessageQuery.bindValue(":flags", (int)msg.flags());
-        logMessageQuery.bindValue(":sender", msg.sender());
-        logMessageQuery.bindValue(":realname", msg.realName());
-        logMessageQuery.bindValue(":avatarurl", msg.avatarUrl());
-        logMessageQuery.bindValue(":senderprefixes", msg.senderPrefixes());
-        logMessageQuery.bindValue(":message", msg.contents());
+        QSqlQuery query(db);
+        query.prepare(queryString("select_buffer_states"));
+        query.bindValue(":userid", user.toInt());
 
-        lockForWrite();
-        safeExec(logMessageQuery);
-
-        if (logMessageQuery.lastError().isValid()) {
-            // constraint violation - must be NOT NULL constraint - probably the sender is missing...
-            if (logMessageQuery.lastError().number() == 19) {
-                QSqlQuery addSenderQuery(db);
-                addSenderQuery.prepare(queryString("insert_sender"));
-                addSenderQuery.bindValue(":sender", msg.sender());
-                addSenderQuery.bindValue(":realname", msg.realName());
-                addSenderQuery.bindValue(":avatarurl", msg.avatarUrl());
-                safeExec(addSenderQuery);
-                safeExec(logMessageQuery);
-                error = !watchQuery(logMessageQuery);
-            }
-            else {
-                watchQuery(logMessageQuery);
-            }
-        }
+        lockForRead();
+        safeExec(query);
+        error = !watchQuery(query);
         if (!error) {
-            MsgId msgId = logMessageQuery.lastInsertId().toLongLong();
-            if (msgId.isValid()) {
-                msg.setMsgId(msgId);
-            }
-            else {
-                error = true;
+            while (query.next()) {
+                BufferId bufferId = query.value(0).toInt();
+                states.lastSeenMsgIds[bufferId] = query.value(1).toLongLong();
+                states.markerLineMsgIds[bufferId] = query.value(2).toLongLong();
+                states.activities[bufferId] = Message::Types(query.value(3).toInt());
+                states.highlightCounts[bufferId] = query.value(4).toInt();
             }
         }
     }
 
-    if (error) {
-        db.rollback();
-    }
-    else {
-        db.commit();
-    }
-
+    db.commit();
     unlock();
-    return !error;
+    return states;
+}
+
+bool SqliteStorage::logMessage(Message &msg)
+{
+    MessageList msgs;
+    msgs << msg;
+    if (!logMessages(msgs))
+        return false;
+
+    msg.setMsgId(msgs.first().msgId());
+    return true;
 }
 
 
 bool SqliteStorage::logMessages(MessageList &msgs)
 {
+    if (msgs.isEmpty())
+        return true;
+
     QSqlDatabase db = logDb();
     db.transaction();
 
+    bool error = false;
+    QHash<SenderData, qint64> newSenders;
+    lockForWrite();
     {
-        QSet<SenderData> senders;
-        QSqlQuery addSenderQuery(db);
-        addSenderQuery.prepare(queryString("insert_sender"));
-        lockForWrite();
+        // Resolve all senders first; most of them are served from the sender id cache, so the
+        // backlog rows below can reference the senderid directly instead of using a subquery.
+        QVector<qint64> senderIds;
+        senderIds.reserve(msgs.count());
         for (int i = 0; i < msgs.count(); i++) {
             auto &msg = msgs.at(i);
-            SenderData sender = { msg.sender(), msg.realName(), msg.avatarUrl() };
-            if (senders.contains(sender))
-                continue;
-            senders << sender;
-
-            addSenderQuery.bindValue(":sender", sender.sender);
-            addSenderQuery.bindValue(":realname", sender.realname);
-            addSenderQuery.bindValue(":avatarurl", sender.avatarurl);
-            safeExec(addSenderQuery);
+            qint64 id = senderId(db, { msg.sender(), msg.realName(), msg.avatarUrl() }, newSenders);
+            if (id < 0) {
+                error = true;
+                break;
+            }
+            senderIds << id;
         }
-    }
 
-    bool error = false;
-    {
         QSqlQuery logMessageQuery(db);
-        logMessageQuery.prepare(queryString("insert_message"));
-        for (int i = 0; i < msgs.count(); i++) {
-            Message &msg = msgs[i];
-            // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
-            // seconds.  This nets us more precision as well as simplifying 64-bit time.
-            logMessageQuery.bindValue(":time", msg.timestamp().toMSecsSinceEpoch());
-            logMessageQuery.bindValue(":bufferid", msg.bufferInfo().bufferId().toInt());
-            logMessageQuery.bindValue(":type", msg.type());
-            logMessageQuery.bindValue(":flags", (int)msg.flags());
-            logMessageQuery.bindValue(":sender", msg.sender());
-            logMessageQuery.bindValue(":realname", msg.realName());
-            logMessageQuery.bindValue(":avatarurl", msg.avatarUrl());
-            logMessageQuery.bindValue(":senderprefixes", msg.senderPrefixes());
-            logMessageQuery.bindValue(":message", msg.contents());
+        int preparedRows = 0;
+        for (int offset = 0; !error && offset < msgs.count(); offset += _maxMessagesPerInsert) {
+            int rows = qMin(_maxMessagesPerInsert, msgs.count() - offset);
+            if (rows != preparedRows) {
+                logMessageQuery.prepare(insertMessagesQuery(rows));
+                preparedRows = rows;
+            }
+
+            int pos = 0;
+            for (int i = offset; i < offset + rows; i++) {
+                const Message &msg = msgs.at(i);
+                // As of SQLite schema version 31, timestamps are stored in milliseconds instead of
+                // seconds.  This nets us more precision as well as simplifying 64-bit time.
+                logMessageQuery.bindValue(pos++, msg.timestamp().toMSecsSinceEpoch());
+                logMessageQuery.bindValue(pos++, msg.bufferInfo().bufferId().toInt());
+                logMessageQuery.bindValue(pos++, msg.type());
+                logMessageQuery.bindValue(pos++, (int)msg.flags());
+                logMessageQuery.bindValue(pos++, senderIds.at(i));
+                logMessageQuery.bindValue(pos++, msg.senderPrefixes());
+                logMessageQuery.bindValue(pos++, msg.contents());
+            }
 
             safeExec(logMessageQuery);
             if (!watchQuery(logMessageQuery)) {
                 error = true;
                 break;
             }
-            else {
-                msg.setMsgId(logMessageQuery.lastInsertId().toLongLong());
+
+            // We hold the write lock, so all rows of one INSERT get consecutive ids ending at
+            // the last inserted rowid.
+            qint64 lastMsgId = logMessageQuery.lastInsertId().toLongLong();
+            if (lastMsgId <= 0) {
+                error = true;
+                break;
+            }
+            for (int i = 0; i < rows; i++) {
+                msgs[offset + i].setMsgId(lastMsgId - rows + 1 + i);
             }
         }
     }
@@ -1874,11 +1905,69 @@ bool SqliteStorage::logMessages(MessageList &msgs)
     else {
         db.commit();
         unlock();
+        for (auto it = newSenders.constBegin(); it != newSenders.constEnd(); ++it)
+            senderIdCache().insert(it.key(), it.value());
     }
     return !error;
 }
 
 
+qint64 SqliteStorage::senderId(QSqlDatabase &db, const SenderData &sender, QHash<SenderData, qint64> &newSenders)
+{
+    auto it = newSenders.constFind(sender);
+    if (it != newSenders.constEnd())
+        return it.value();
+
+    qint64 id = senderIdCache().senderId(sender);
+    if (id >= 0)
+        return id;
+
+    {
+        QSqlQuery selectSenderQuery(db);
+        selectSenderQuery.prepare(queryString("select_senderid"));
+        selectSenderQuery.bindValue(":sender", sender.sender);
+        selectSenderQuery.bindValue(":realname", sender.realname);
+        selectSenderQuery.bindValue(":avatarurl", sender.avatarurl);
+        safeExec(selectSenderQuery);
+        if (watchQuery(selectSenderQuery) && selectSenderQuery.first()) {
+            // the sender is committed already (we're the only writer), so it can be cached right away
+            id = selectSenderQuery.value(0).toLongLong();
+            senderIdCache().insert(sender, id);
+            return id;
+        }
+    }
+
+    {
+        QSqlQuery addSenderQuery(db);
+        addSenderQuery.prepare(queryString("insert_sender"));
+        addSenderQuery.bindValue(":sender", sender.sender);
+        addSenderQuery.bindValue(":realname", sender.realname);
+        addSenderQuery.bindValue(":avatarurl", sender.avatarurl);
+        safeExec(addSenderQuery);
+        if (watchQuery(addSenderQuery)) {
+            id = addSenderQuery.lastInsertId().toLongLong();
+            newSenders[sender] = id;
+        }
+    }
+    return id;
+}
+
+
+QString SqliteStorage::insertMessagesQuery(int rows)
+{
+    static const QString rowPlaceholders("(?, ?, ?, ?, ?, ?, ?)");
+
+    QString query("INSERT INTO backlog (time, bufferid, type, flags, senderid, senderprefixes, message) VALUES ");
+    query.reserve(query.length() + rows * (rowPlaceholders.length() + 2));
+    for (int i = 0; i < rows; i++) {
+        if (i > 0)
+            query += ", ";
+        query += rowPlaceholders;
+    }
+    return query;
+}
+
+
 QList<Message> SqliteStorage::requestMsgs(UserId user, BufferId bufferId, MsgId first, MsgId last, int limit)
 {
     QList<Message> messagelist;
@@ -2155,6 +2244,57 @@ QList<Message> SqliteStorage::requestAllMsgsFiltered(UserId user, MsgId first, M
     return messagelist;
 }
 
+
+QList<MsgId> SqliteStorage::searchMsgs(UserId user, BufferId bufferId, const QString &query, MsgId last, int limit)
+{
+    QList<MsgId> msgIds;
+
+    // Quote every word, so that nothing the user typed is taken for FTS query syntax
+    QStringList words;
+    foreach(QString word, query.split(QRegExp("\\s+"), QString::SkipEmptyParts))
+        words << QString("\"%1\"").arg(word.replace('"', "\"\""));
+    if (words.isEmpty())
+        return msgIds;
+
+    QSqlDatabase db = logDb();
+    db.transaction();
+
+    bool error = false;
+    {
+        QSqlQuery bufferInfoQuery(db);
+        bufferInfoQuery.prepare(queryString("select_buffer_by_id"));
+        bufferInfoQuery.bindValue(":userid", user.toInt());
+        bufferInfoQuery.bindValue(":bufferid", bufferId.toInt());
+
+        lockForRead();
+        safeExec(bufferInfoQuery);
+        error = !watchQuery(bufferInfoQuery) || !bufferInfoQuery.first();
+    }
+    if (error) {
+        db.rollback();
+        unlock();
+        return msgIds;
+    }
+
+    {
+        QSqlQuery searchQuery(db);
+        searchQuery.prepare(queryString("select_messagesSearch"));
+        searchQuery.bindValue(":query", words.join(" "));
+        searchQuery.bindValue(":bufferid", bufferId.toInt());
+        searchQuery.bindValue(":lastmsg", last == -1 ? std::numeric_limits<qint64>::max() : last.toQint64());
+        searchQuery.bindValue(":limit", limit);
+
+        safeExec(searchQuery);
+        watchQuery(searchQuery);
+        while (searchQuery.next())
+            msgIds << searchQuery.value(0).toLongLong();
+    }
+    db.commit();
+    unlock();
+    return msgIds;
+}
+
+
 QMap<UserId, QString> SqliteStorage::getAllAuthUserNames()
 {
     QMap<UserId, QString> authusernames;
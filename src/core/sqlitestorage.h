@@ -22,7 +22,10 @@
 
 #include "abstractsqlstorage.h"
 
+#include <atomic>
+
 #include <QSqlDatabase>
+#include <QThreadStorage>
 
 class QSqlQuery;
 
@@ -104,6 +107,7 @@ public slots:
     void setHighlightCount(UserId id, BufferId bufferId, int count) override;
     QHash<BufferId, int> highlightCounts(UserId id) override;
     int highlightCount(BufferId bufferId, MsgId lastSeenMsgId) override;
+    BufferStates bufferStates(UserId user) override;
     QHash<QString, QByteArray> bufferCiphers(UserId user, const NetworkId &networkId) override;
     void setBufferCipher(UserId user, const NetworkId &networkId, const QString &bufferName, const QByteArray &cipher) override;
 
@@ -118,6 +122,7 @@ public slots:
     QList<Message> requestAllMsgsFiltered(UserId user, MsgId first = -1, MsgId last = -1, int limit = -1,
                                           Message::Types type = Message::Types{-1},
                                           Message::Flags flags = Message::Flags{-1}) override;
+    QList<MsgId> searchMsgs(UserId user, BufferId bufferId, const QString &query, MsgId last = -1, int limit = -1) override;
 
     /* Sysident handling */
     QMap<UserId, QString> getAllAuthUserNames() override;
@@ -131,6 +136,7 @@ protected:
         Q_UNUSED(loadFromEnvironment);
     }
     // SQLite does not have any connection properties to set
+    bool initDbSession(QSqlDatabase &db) override;
     QString driverName()  override { return "QSQLITE"; }
     QString databaseName()  override { return backlogFile(); }
     int installedSchemaVersion() override;
@@ -143,11 +149,32 @@ private:
     void bindNetworkInfo(QSqlQuery &query, const NetworkInfo &info);
     void bindServerInfo(QSqlQuery &query, const Network::Server &server);
 
-    inline void lockForRead() { _dbLock.lockForRead(); }
-    inline void lockForWrite() { _dbLock.lockForWrite(); }
-    inline void unlock() { _dbLock.unlock(); }
+    //! Returns the senderid for the given sender, creating it if necessary (-1 on error)
+    /** Must be called with the write lock held and a transaction open. Newly inserted senders are
+     *  added to newSenders and must only be put into the sender id cache after committing.
+     */
+    qint64 senderId(QSqlDatabase &db, const SenderData &sender, QHash<SenderData, qint64> &newSenders);
+    //! Builds an INSERT statement for the given number of backlog rows with positional placeholders
+    static QString insertMessagesQuery(int rows);
+
+    // In WAL mode, readers work on their own snapshot and never block on the writer (nor the
+    // writer on them), so only writes need to be serialized. A transaction that writes must take
+    // the write lock before its first read, though: otherwise a commit from another connection in
+    // between makes the upgrade of the outdated snapshot fail with SQLITE_BUSY_SNAPSHOT.
+    inline void lockForRead() { if (!_walMode) _dbLock.lockForRead(); }
+    inline void lockForWrite() { _dbLock.lockForWrite(); _holdsWriteLock.setLocalData(true); }
+    inline void unlock()
+    {
+        if (!_walMode || _holdsWriteLock.localData()) {
+            _holdsWriteLock.setLocalData(false);
+            _dbLock.unlock();
+        }
+    }
     QReadWriteLock _dbLock;
+    QThreadStorage<bool> _holdsWriteLock;
+    std::atomic<bool> _walMode{false};  ///< Set by initDbSession(), which may run on any thread
     static int _maxRetryCount;
+    static const int _maxMessagesPerInsert;
 };
 
 
@@ -49,6 +49,14 @@ public:
 
     };
 
+    //! The persistent state of all buffers of a user, as needed by the BufferSyncer
+    struct BufferStates {
+        QHash<BufferId, MsgId> lastSeenMsgIds;
+        QHash<BufferId, MsgId> markerLineMsgIds;
+        QHash<BufferId, Message::Types> activities;
+        QHash<BufferId, int> highlightCounts;
+    };
+
 public slots:
     /* General */
 
@@ -474,6 +482,16 @@ public slots:
      */
     virtual int highlightCount(BufferId bufferId, MsgId lastSeenMsgId) = 0;
 
+    //! Get the last seen and marker line message ids, activities and highlight counts of all buffers
+    /** This Method is called when a session is started to restore the BufferSyncer state. It is
+     *  equivalent to calling bufferLastSeenMsgIds(), bufferMarkerLineMsgIds(), bufferActivities() and
+     *  highlightCounts(), but only needs a single query.
+     *  \note This method is threadsafe.
+     *
+     * \param user      The Owner of the buffers
+     */
+    virtual BufferStates bufferStates(UserId user) = 0;
+
     /* Message handling */
 
     //! Store a Message in the storage backend and set its unique Id.
@@ -528,6 +546,15 @@ public slots:
                                                   Message::Types type = Message::Types{-1},
                                                   Message::Flags flags = Message::Flags{-1}) = 0;
 
+    //! Search the messages stored in a given buffer for a number of words
+    /** \param buffer   The buffer we search messages in
+     *  \param query    Whitespace-separated words that all have to occur in a message, ignoring case
+     *  \param last     if != -1 return only messages with a MsgId < last, for fetching the next page
+     *  \param limit    if != -1 limit the returned list to a max of \limit entries
+     *  \return The ids of the matching messages, newest first
+     */
+    virtual QList<MsgId> searchMsgs(UserId user, BufferId bufferId, const QString &query, MsgId last = -1, int limit = -1) = 0;
+
     //! Fetch all authusernames
     /** \return      Map of all current UserIds to permitted idents
      */
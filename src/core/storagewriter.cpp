@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2018 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+
+#include "storagewriter.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "logmessage.h"
+#include "quassel.h"
+#include "storage.h"
+
+const int MessagesStoredEvent::EventId = QEvent::registerEventType();
+
+StorageWriter::StorageWriter(DeferredSharedPtr<Storage> storage, int maxQueuedMessages, QObject *parent)
+    : QThread(parent),
+    _storage(std::move(storage)),
+    _maxQueuedMessages(maxQueuedMessages),
+    _commitLatency(_latencyBuckets, 0)
+{
+    start();
+}
+
+
+StorageWriter::~StorageWriter()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _stopping = true;
+        _requestsAvailable.wakeAll();
+    }
+    // the writer thread drains the queue before it exits
+    wait();
+
+    if (Quassel::isOptionSet("debug")) {
+        QStringList buckets;
+        for (int i = 0; i < _commitLatency.count(); i++)
+            buckets << QString("<%1ms: %2").arg(1 << i).arg(_commitLatency.at(i));
+        qDebug() << "Storage commit latencies:" << qPrintable(buckets.join(", "));
+    }
+}
+
+
+void StorageWriter::enqueue(const MessageList &messages, QObject *receiver)
+{
+    if (messages.isEmpty())
+        return;
+
+    QMutexLocker locker(&_mutex);
+    // apply backpressure, but never block a request on an empty queue
+    while (_queuedMessages >= _maxQueuedMessages && !_queue.isEmpty() && !_stopping)
+        _queueNotFull.wait(&_mutex);
+
+    _queue.enqueue({messages, receiver});
+    _queuedMessages += messages.count();
+    _requestsAvailable.wakeOne();
+}
+
+
+void StorageWriter::flush(QObject *receiver)
+{
+    QMutexLocker locker(&_mutex);
+    while (hasPendingRequests(receiver))
+        _requestsDone.wait(&_mutex);
+}
+
+
+QVector<quint64> StorageWriter::commitLatencyHistogram() const
+{
+    QMutexLocker locker(&_mutex);
+    return _commitLatency;
+}
+
+
+bool StorageWriter::hasPendingRequests(QObject *receiver) const
+{
+    for (const Request &request : _queue) {
+        if (request.receiver == receiver)
+            return true;
+    }
+    return _inFlightReceivers.contains(receiver);
+}
+
+
+void StorageWriter::run()
+{
+    forever {
+        QList<Request> batch;
+        {
+            QMutexLocker locker(&_mutex);
+            while (_queue.isEmpty() && !_stopping)
+                _requestsAvailable.wait(&_mutex);
+            if (_queue.isEmpty())
+                return;
+
+            // group everything that piled up during the last commit into the next one
+            int messageCount = 0;
+            while (!_queue.isEmpty() && (batch.isEmpty() || messageCount + _queue.head().messages.count() <= _maxMessagesPerCommit)) {
+                messageCount += _queue.head().messages.count();
+                _inFlightReceivers << _queue.head().receiver;
+                batch << _queue.dequeue();
+            }
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        if (!store(batch) && batch.count() > 1) {
+            // don't let one broken request take down the others that were grouped with it
+            for (int i = 0; i < batch.count(); i++) {
+                QList<Request> single;
+                single << batch.at(i);
+                store(single);
+                batch[i] = single.first();
+            }
+        }
+        qint64 elapsed = timer.elapsed();
+
+        QMutexLocker locker(&_mutex);
+        recordCommitLatency(elapsed);
+        for (const Request &request : batch) {
+            bool success = !request.messages.isEmpty() && request.messages.last().msgId().isValid();
+            QCoreApplication::postEvent(request.receiver, new MessagesStoredEvent(request.messages, success));
+            _queuedMessages -= request.messages.count();
+        }
+        _inFlightReceivers.clear();
+        _queueNotFull.wakeAll();
+        _requestsDone.wakeAll();
+    }
+}
+
+
+bool StorageWriter::store(QList<Request> &requests)
+{
+    MessageList messages;
+    for (const Request &request : requests)
+        messages << request.messages;
+
+    bool success = _storage->logMessages(messages);
+
+    // hand the assigned MsgIds (or the reset ones on failure) back to the requests
+    int offset = 0;
+    for (Request &request : requests) {
+        for (int i = 0; i < request.messages.count(); i++)
+            request.messages[i].setMsgId(messages.at(offset + i).msgId());
+        offset += request.messages.count();
+    }
+    return success;
+}
+
+
+void StorageWriter::recordCommitLatency(qint64 msecs)
+{
+    int bucket = 0;
+    while (bucket < _latencyBuckets - 1 && msecs >= (qint64(1) << bucket))
+        bucket++;
+    _commitLatency[bucket]++;
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2018 by the Quassel Project                        *
+ *   devel@quassel-irc.org                                                 *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3.                                           *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.         *
+ ***************************************************************************/
+
+
+#pragma once
+
+#include <QEvent>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "deferredptr.h"
+#include "message.h"
+
+class Storage;
+
+//! Posted to the requesting object once its messages have been written to the storage backend
+class MessagesStoredEvent : public QEvent
+{
+public:
+    static const int EventId;
+
+    MessagesStoredEvent(const MessageList &messages, bool success)
+        : QEvent(QEvent::Type(EventId)), messages(messages), success(success) {}
+
+    MessageList messages;  ///< The stored messages, with their MsgIds set on success
+    bool success;
+};
+
+
+//! Writes messages to the storage backend in a dedicated thread
+/** Sessions enqueue their messages and continue processing IRC traffic while the writer thread
+ *  commits them. Requests queued up while a commit is running are grouped into a single
+ *  logMessages() call, regardless of the session they belong to. Once a request has been written,
+ *  a MessagesStoredEvent is posted to its receiver.
+ *
+ *  The number of queued messages is bounded; enqueue() blocks the calling thread while the queue
+ *  is full, so a slow backend throttles the sessions instead of growing the queue without limit.
+ */
+class StorageWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    StorageWriter(DeferredSharedPtr<Storage> storage, int maxQueuedMessages = 10000, QObject *parent = 0);
+    ~StorageWriter() override;
+
+    //! Queues messages for storage; receiver gets a MessagesStoredEvent once they have been written
+    /** \note This method is threadsafe. It blocks while the queue is full.
+     */
+    void enqueue(const MessageList &messages, QObject *receiver);
+
+    //! Blocks until all pending requests for the given receiver have been processed
+    /** Call this before destroying a receiver, so no events will be posted to it afterwards.
+     *  \note This method is threadsafe.
+     */
+    void flush(QObject *receiver);
+
+    //! Number of commits per latency bucket; bucket i counts commits that took less than 2^i ms
+    QVector<quint64> commitLatencyHistogram() const;
+
+protected:
+    void run() override;
+
+private:
+    struct Request {
+        MessageList messages;
+        QObject *receiver;
+    };
+
+    bool store(QList<Request> &requests);
+    void recordCommitLatency(qint64 msecs);
+    bool hasPendingRequests(QObject *receiver) const;
+
+    static const int _latencyBuckets = 18;
+    static const int _maxMessagesPerCommit = 2000;
+
+    DeferredSharedPtr<Storage> _storage;
+    int _maxQueuedMessages;
+
+    mutable QMutex _mutex;
+    QWaitCondition _requestsAvailable;
+    QWaitCondition _queueNotFull;
+    QWaitCondition _requestsDone;
+    QQueue<Request> _queue;
+    QList<QObject *> _inFlightReceivers;
+    int _queuedMessages{0};
+    bool _stopping{false};
+
+    QVector<quint64> _commitLatency;
+};
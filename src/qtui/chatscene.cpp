@@ -20,6 +20,8 @@
 
 #include "chatscene.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QClipboard>
 #include <QDesktopServices>
@@ -424,11 +426,25 @@ void ChatScene::rowsInserted(const QModelIndex &index, int start, int end)
     }
 
     // neither pre- or append means we have to do dirty work: move items...
+    // The new lines have been placed where the line at start used to be, so either everything above them
+    // has to move up, or everything below them has to move down. Moving the bottom part pushes down what the
+    // view shows, which lastLineChanged() only compensates for if the view follows the bottom. So we only
+    // move it if the view is scrolled to the bottom, and it's the smaller part.
+    bool movedBottomPart = false;
     if (!(atTop || atBottom)) {
+        qreal offset = -h;
+        int moveStart = 0;
+        int moveEnd = end;
+        if (_lines.count() - end - 1 < start && chatView() && chatView()->isScrolledToBottom()) {
+            moveStart = end + 1;
+            moveEnd = _lines.count() - 1;
+            offset = h;
+            movedBottomPart = true;
+        }
         ChatLine *line = 0;
-        for (int i = 0; i <= end; i++) {
+        for (int i = moveStart; i <= moveEnd; i++) {
             line = _lines.at(i);
-            line->setPos(0, line->pos().y() - h);
+            line->setPos(0, line->pos().y() + offset);
             if (line == markerLine()->chatLine())
                 markerLine()->setPos(line->pos() + QPointF(0, line->height()));
         }
@@ -467,7 +483,8 @@ void ChatScene::rowsInserted(const QModelIndex &index, int start, int end)
         _firstLineRow = -1;
     }
     updateSceneRect();
-    if (atBottom) {
+    if (atBottom || movedBottomPart) {
+        // the last line has moved down as well, so keep the view at the bottom if it was there
         emit lastLineChanged(_lines.last(), h);
     }
 
@@ -1153,15 +1170,16 @@ ChatLineModel::ColumnType ChatScene::columnByScenePos(qreal x) const
 
 int ChatScene::rowByScenePos(qreal y) const
 {
-    QList<QGraphicsItem *> itemList = items(QPointF(0, y));
-
-    // ChatLine should be at the bottom of the list
-    for (int i = itemList.count()-1; i >= 0; i--) {
-        ChatLine *line = qgraphicsitem_cast<ChatLine *>(itemList.at(i));
-        if (line)
-            return line->row();
-    }
-    return -1;
+    // Lines are stacked without gaps in row order, so we can bisect them instead of querying the scene index
+    QList<ChatLine *>::const_iterator it = std::upper_bound(_lines.constBegin(), _lines.constEnd(), y,
+        [](qreal y, const ChatLine *line) { return y < line->pos().y(); });
+    if (it == _lines.constBegin())
+        return -1;
+
+    const ChatLine *line = *(--it);
+    if (y >= line->pos().y() + line->height() || !line->isVisible())
+        return -1;
+    return line->row();
 }
 
 
@@ -346,6 +346,13 @@ ChatLine *ChatView::lastVisibleChatLine(bool ignoreDayChange) const
 }
 
 
+bool ChatView::isScrolledToBottom() const
+{
+    QAbstractSlider *vbar = verticalScrollBar();
+    return vbar->value() == vbar->maximum();
+}
+
+
 void ChatView::setMarkerLineVisible(bool visible)
 {
     scene()->setMarkerLineVisible(visible);
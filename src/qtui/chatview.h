@@ -68,6 +68,9 @@ public:
      */
     ChatLine *lastVisibleChatLine(bool ignoreDayChange = false) const;
 
+    //! Whether the view is scrolled all the way down, i.e. it follows new lines appended to the scene
+    bool isScrolledToBottom() const;
+
     virtual void addActionsToMenu(QMenu *, const QPointF &pos);
 
     //! Tell the view that this ChatLine has cached data
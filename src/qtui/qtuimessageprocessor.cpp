@@ -133,7 +133,8 @@ void QtUiMessageProcessor::checkForHighlight(Message &msg)
 
         // Get buffer name, message contents
         QString bufferName = msg.bufferInfo().bufferName();
-        QString msgContents = msg.contents();
+        // Strip formatting once per message rather than once per rule
+        const QString strippedContents = stripFormatCodes(msg.contents());
         bool matches = false;
 
         for (int i = 0; i < _highlightRuleList.count(); i++) {
@@ -154,7 +155,7 @@ void QtUiMessageProcessor::checkForHighlight(Message &msg)
             }
 
             // Check message according to specified rule, allowing empty rules to match
-            bool contentsMatch = rule.contentsMatcher().match(stripFormatCodes(msgContents), true);
+            bool contentsMatch = rule.contentsMatcher().match(strippedContents, true);
 
             // Support for sender matching can be added here
 
@@ -173,7 +174,7 @@ void QtUiMessageProcessor::checkForHighlight(Message &msg)
         if (_highlightNick != HighlightNickType::NoNick && !currentNick.isEmpty()) {
             // Nickname matching allowed and current nickname is known
             // Run the nickname matcher on the unformatted string
-            if (_nickMatcher.match(stripFormatCodes(msgContents), netId, currentNick,
+            if (_nickMatcher.match(strippedContents, netId, currentNick,
                                    identityNicks)) {
                 msg.setFlags(msg.flags() | Message::Highlight);
                 return;